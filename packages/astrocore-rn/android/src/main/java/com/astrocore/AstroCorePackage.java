@@ -52,5 +52,20 @@ public class AstroCorePackage implements ReactPackage {
     });
   }
 
+  /**
+   * Releases the JSI values the bindings cache in the runtime. Call before the
+   * React instance is destroyed, while its JS thread still runs.
+   */
+  public static void uninstall(@NonNull ReactApplicationContext reactContext) {
+    reactContext.runOnJSQueueThread(() -> {
+      long runtimePointer = reactContext.getJavaScriptContextHolder().get();
+      if (runtimePointer != 0L) {
+        nativeUninstall(runtimePointer);
+      }
+    });
+  }
+
   private static native void nativeInstall(long runtimePointer);
+
+  private static native void nativeUninstall(long runtimePointer);
 }
@@ -7,11 +7,25 @@ LOCAL_SRC_FILES := \
   ../../../../cpp/src/time.cpp \
   ../../../../cpp/src/transform.cpp \
   ../../../../cpp/src/vector.cpp \
+  ../../../../cpp/src/visibility.cpp \
+  ../../../../cpp/src/sky_index.cpp \
+  ../../../../cpp/src/catalog.cpp \
+  ../../../../cpp/src/catalog_file.cpp \
+  ../../../../cpp/src/mapped_file.cpp \
   ../../../../cpp/src/engine.cpp \
+  ../../../../cpp/src/frame_clock.cpp \
+  ../../../../cpp/src/frame_format.cpp \
+  ../../../../cpp/src/frame_stats.cpp \
+  ../../../../cpp/src/pose_history.cpp \
+  ../../../../cpp/src/trace.cpp \
+  ../../../../cpp/src/worker_pool.cpp \
+  ../../../../cpp/src/projection_kernel.cpp \
+  ../../../../cpp/src/projection_neon.cpp \
+  ../../../../cpp/src/projection_x86.cpp \
   ../../../../cpp/src/jsi_bindings.cpp \
   ../../../../cpp/src/AstroCoreHostObject.cpp
 
-LOCAL_CFLAGS := -std=c++20 -O2 -DNDEBUG
+LOCAL_CFLAGS := -std=c++20 -O2 -DNDEBUG -ffp-contract=off
 LOCAL_LDLIBS := -llog
 
 LOCAL_C_INCLUDES := \
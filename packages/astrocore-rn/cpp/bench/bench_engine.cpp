@@ -0,0 +1,413 @@
+// Throughput benchmark for the engine and its per-star stages.
+//
+//   bench_engine [--max-stars N] [--min-time-ms T] [--frame-stats] [--frame-format float32|fixed16|half|vertex]
+//
+// Prints one JSON document to stdout so runs from different builds can be
+// diffed or fed to a regression check. Catalogs are synthetic and seeded, so
+// numbers are comparable across machines running the same build.
+
+#include "astro/engine.hpp"
+#include "astro/time.hpp"
+#include "astro/transform.hpp"
+#include "astro/vector.hpp"
+#include "astro/visibility.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr double kRadToDeg = 57.295779513082320877;
+constexpr double kDegToRad = 0.01745329251994329577;
+constexpr double kJulianDate = 2460000.5;
+constexpr std::size_t kStageSamples = std::size_t{1} << 16;
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+  std::size_t maxStars{2000000};
+  double minTimeMs{200.0};
+  // Frames are timed with EngineConfig::recordFrameStats on.
+  bool frameStats{false};
+  astro::FrameFormat frameFormat{astro::FrameFormat::Float32};
+  const char* frameFormatName{"float32"};
+};
+
+// Keeps results observable so the timed loops are not optimized away.
+volatile double gSink = 0.0;
+
+double elapsedMs(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Runs `batch` (which performs `perBatch` operations) until at least
+// `minTimeMs` has passed, and returns the mean nanoseconds per operation.
+template <typename Batch>
+double nsPerOperation(Batch&& batch, std::size_t perBatch, double minTimeMs) {
+  batch();  // warm-up
+  std::size_t batches = 0;
+  const auto start = Clock::now();
+  double ms = 0.0;
+  do {
+    batch();
+    ++batches;
+    ms = elapsedMs(start);
+  } while (ms < minTimeMs);
+  return ms * 1e6 / static_cast<double>(batches * perBatch);
+}
+
+// Uniform over the sphere with magnitudes uniform in [-1.5, 9].
+std::vector<astro::StarIn> uniformCatalog(std::size_t count, std::mt19937_64& rng) {
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  std::vector<astro::StarIn> stars(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    stars[i].raDeg = unit(rng) * 360.0;
+    stars[i].decDeg = std::asin(unit(rng) * 2.0 - 1.0) * kRadToDeg;
+    stars[i].mag = -1.5 + unit(rng) * 10.5;
+    stars[i].hip = static_cast<int>(i + 1);
+  }
+  return stars;
+}
+
+// Uniform over the sphere with star counts growing as 10^(0.45 m), the slope
+// of real catalogs, scaled so about 9000 stars are brighter than 6.5: larger
+// catalogs reach fainter, as they do in practice.
+std::vector<astro::StarIn> realisticCatalog(std::size_t count, std::mt19937_64& rng) {
+  constexpr double kSlope = 0.45;
+  constexpr double kBrightest = -1.5;
+  const double faintest = 6.5 + std::log10(static_cast<double>(count) / 9000.0) / kSlope;
+  const double span = std::pow(10.0, kSlope * (faintest - kBrightest)) - 1.0;
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  std::vector<astro::StarIn> stars(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    stars[i].raDeg = unit(rng) * 360.0;
+    stars[i].decDeg = std::asin(unit(rng) * 2.0 - 1.0) * kRadToDeg;
+    stars[i].mag = kBrightest + std::log10(1.0 + unit(rng) * span) / kSlope;
+    stars[i].hip = static_cast<int>(i + 1);
+  }
+  return stars;
+}
+
+struct NamedPose {
+  const char* name;
+  astro::PoseQuat pose;
+};
+
+// Device looking at the horizon, at the zenith, and somewhere in between.
+constexpr NamedPose kPoses[] = {
+    {"horizon", {0.7071068, 0.7071068, 0.0, 0.0}},
+    {"zenith", {1.0, 0.0, 0.0, 0.0}},
+    {"oblique", {0.8446232, 0.4619398, 0.1913417, 0.1913417}},
+};
+constexpr double kFovsDeg[] = {20.0, 60.0, 100.0};
+constexpr std::size_t kCatalogSizes[] = {1000, 10000, 100000, 1000000, 2000000};
+
+void printStage(const char* name, double ns, bool last) {
+  std::printf("    {\"name\": \"%s\", \"ns_per_call\": %.3f}%s\n", name, ns, last ? "" : ",");
+}
+
+void benchStages(const Options& options) {
+  std::mt19937_64 rng(7);
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  std::vector<double> jd(kStageSamples);
+  std::vector<double> ra(kStageSamples);
+  std::vector<double> dec(kStageSamples);
+  std::vector<double> alt(kStageSamples);
+  std::vector<astro::Vec3> directions(kStageSamples);
+  for (std::size_t i = 0; i < kStageSamples; ++i) {
+    jd[i] = kJulianDate + unit(rng) * 365.0;
+    ra[i] = unit(rng) * 360.0;
+    dec[i] = std::asin(unit(rng) * 2.0 - 1.0) * kRadToDeg;
+    alt[i] = (unit(rng) * 91.0 - 1.0) * kDegToRad;
+    directions[i] = astro::vector::equatorialToUnit(ra[i], dec[i]);
+  }
+
+  const double lst = astro::time::localSiderealTimeRad(kJulianDate, -122.4194);
+  const astro::Quaternion orientation = astro::Quaternion::fromPose(kPoses[2].pose);
+  astro::EngineConfig config;
+  config.fovDeg = 60.0;
+  config.screen = {1080, 1920};
+  const astro::ScreenProjection projection = astro::vector::makeScreenProjection(config);
+  const astro::transform::RefractionTable table;
+
+  std::printf("  \"stages\": [\n");
+  printStage("localSiderealTimeRad",
+             nsPerOperation(
+                 [&] {
+                   double sum = 0.0;
+                   for (std::size_t i = 0; i < kStageSamples; ++i) {
+                     sum += astro::time::localSiderealTimeRad(jd[i], -122.4194);
+                   }
+                   gSink = sum;
+                 },
+                 kStageSamples,
+                 options.minTimeMs),
+             false);
+  printStage("equatorialToHorizontal",
+             nsPerOperation(
+                 [&] {
+                   double sum = 0.0;
+                   for (std::size_t i = 0; i < kStageSamples; ++i) {
+                     sum += astro::transform::equatorialToHorizontal(ra[i], dec[i], lst, 37.7749).altRad;
+                   }
+                   gSink = sum;
+                 },
+                 kStageSamples,
+                 options.minTimeMs),
+             false);
+  printStage("applyRefraction",
+             nsPerOperation(
+                 [&] {
+                   double sum = 0.0;
+                   for (std::size_t i = 0; i < kStageSamples; ++i) {
+                     sum += astro::transform::applyRefraction(alt[i]);
+                   }
+                   gSink = sum;
+                 },
+                 kStageSamples,
+                 options.minTimeMs),
+             false);
+  printStage("RefractionTable::lookup",
+             nsPerOperation(
+                 [&] {
+                   float sum = 0.0f;
+                   for (std::size_t i = 0; i < kStageSamples; ++i) {
+                     float scale = 0.0f;
+                     float up = 0.0f;
+                     table.lookup(static_cast<float>(directions[i].z), scale, up);
+                     sum += scale + up;
+                   }
+                   gSink = sum;
+                 },
+                 kStageSamples,
+                 options.minTimeMs),
+             false);
+  printStage("rotateToDevice",
+             nsPerOperation(
+                 [&] {
+                   double sum = 0.0;
+                   for (std::size_t i = 0; i < kStageSamples; ++i) {
+                     sum += astro::vector::rotateToDevice(directions[i], orientation).z;
+                   }
+                   gSink = sum;
+                 },
+                 kStageSamples,
+                 options.minTimeMs),
+             false);
+  printStage("projectToScreen",
+             nsPerOperation(
+                 [&] {
+                   float sum = 0.0f;
+                   for (std::size_t i = 0; i < kStageSamples; ++i) {
+                     float x = 0.0f;
+                     float y = 0.0f;
+                     if (astro::vector::projectToScreen(directions[i], projection, x, y)) {
+                       sum += x + y;
+                     }
+                   }
+                   gSink = sum;
+                 },
+                 kStageSamples,
+                 options.minTimeMs),
+             false);
+
+  // Batch forms over the same samples, structure-of-arrays.
+  std::vector<double> outA(kStageSamples);
+  std::vector<double> outB(kStageSamples);
+  std::vector<double> deviceX(kStageSamples);
+  std::vector<double> deviceY(kStageSamples);
+  std::vector<double> deviceZ(kStageSamples);
+  for (std::size_t i = 0; i < kStageSamples; ++i) {
+    const astro::Vec3 device = astro::vector::rotateToDevice(directions[i], orientation);
+    deviceX[i] = device.x;
+    deviceY[i] = device.y;
+    deviceZ[i] = device.z;
+  }
+  std::vector<float> screenX(kStageSamples);
+  std::vector<float> screenY(kStageSamples);
+  std::vector<std::uint8_t> visible(kStageSamples);
+  printStage("equatorialToHorizontal[batch]",
+             nsPerOperation(
+                 [&] {
+                   astro::transform::equatorialToHorizontal(ra, dec, lst, 37.7749, outA, outB);
+                   gSink = outA[kStageSamples - 1];
+                 },
+                 kStageSamples,
+                 options.minTimeMs),
+             false);
+  printStage("applyRefraction[batch]",
+             nsPerOperation(
+                 [&] {
+                   astro::transform::applyRefraction(alt, outA);
+                   gSink = outA[kStageSamples - 1];
+                 },
+                 kStageSamples,
+                 options.minTimeMs),
+             false);
+  printStage("projectToScreen[batch]",
+             nsPerOperation(
+                 [&] {
+                   gSink = static_cast<double>(astro::vector::projectToScreen(
+                       deviceX, deviceY, deviceZ, projection, screenX, screenY, visible));
+                 },
+                 kStageSamples,
+                 options.minTimeMs),
+             false);
+
+  // Star trails: 10k stars over 500 one-minute samples on one thread, per
+  // star and sample.
+  constexpr std::size_t kTrackStars = 10000;
+  constexpr std::size_t kTrackSamples = 500;
+  std::vector<astro::StarIn> trackStars(kTrackStars);
+  for (std::size_t i = 0; i < kTrackStars; ++i) {
+    trackStars[i] = {ra[i], dec[i], 5.0, static_cast<int>(i + 1)};
+  }
+  astro::StarCatalog trackCatalog;
+  trackCatalog.assign(trackStars);
+  std::vector<float> tracks(astro::visibility::trackFloats(kTrackSamples, kTrackStars));
+  astro::visibility::TrackOptions trackOptions;
+  trackOptions.threads = 1;
+  printStage("computeTracks",
+             nsPerOperation(
+                 [&] {
+                   astro::visibility::computeTracks(
+                       trackCatalog, {37.7749, -122.4194, 0.0}, kJulianDate, 1.0 / 1440.0, kTrackSamples, tracks,
+                       trackOptions);
+                   gSink = tracks.back();
+                 },
+                 kTrackStars * kTrackSamples,
+                 options.minTimeMs),
+             true);
+  std::printf("  ],\n");
+}
+
+void benchFrames(const Options& options) {
+  std::printf("  \"frames\": [\n");
+  bool first = true;
+  for (const char* catalogName : {"uniform", "realistic"}) {
+    for (const std::size_t count : kCatalogSizes) {
+      if (count > options.maxStars) {
+        continue;
+      }
+      std::mt19937_64 rng(count);
+      const std::vector<astro::StarIn> stars =
+          std::strcmp(catalogName, "uniform") == 0 ? uniformCatalog(count, rng) : realisticCatalog(count, rng);
+
+      astro::AstroEngine engine;
+      engine.setObserver({37.7749, -122.4194, 0.0});
+      const auto loadStart = Clock::now();
+      engine.setStars(stars);
+      const double loadMs = elapsedMs(loadStart);
+
+      for (const bool refraction : {false, true}) {
+        for (const double fovDeg : kFovsDeg) {
+          astro::EngineConfig config;
+          config.fovDeg = fovDeg;
+          config.screen = {1080, 1920};
+          config.applyRefraction = refraction;
+          config.recordFrameStats = options.frameStats;
+          config.frameFormat = options.frameFormat;
+          engine.setConfig(config);
+
+          for (const NamedPose& pose : kPoses) {
+            // Advance the clock a little every frame, like a live view.
+            std::size_t frame = 0;
+            std::size_t visible = 0;
+            const double nsPerFrame = nsPerOperation(
+                [&] {
+                  visible = engine.computeFrame(kJulianDate + static_cast<double>(frame++) * 1e-6, pose.pose);
+                },
+                1,
+                options.minTimeMs);
+            std::printf("%s    {\"catalog\": \"%s\", \"stars\": %zu, \"load_ms\": %.3f, \"fov_deg\": %.0f, "
+                        "\"refraction\": %s, \"pose\": \"%s\", \"visible\": %zu, \"ms_per_frame\": %.4f, "
+                        "\"ns_per_star\": %.3f, \"fps\": %.1f}",
+                        first ? "" : ",\n",
+                        catalogName,
+                        count,
+                        loadMs,
+                        fovDeg,
+                        refraction ? "true" : "false",
+                        pose.name,
+                        visible,
+                        nsPerFrame * 1e-6,
+                        nsPerFrame / static_cast<double>(count),
+                        1e9 / nsPerFrame);
+            std::fflush(stdout);
+            first = false;
+          }
+        }
+      }
+    }
+  }
+  std::printf("\n  ]\n");
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (i + 1 < argc && arg == "--max-stars") {
+      options.maxStars = std::strtoull(argv[++i], nullptr, 10);
+    } else if (i + 1 < argc && arg == "--min-time-ms") {
+      options.minTimeMs = std::strtod(argv[++i], nullptr);
+    } else if (arg == "--frame-stats") {
+      options.frameStats = true;
+    } else if (i + 1 < argc && arg == "--frame-format") {
+      options.frameFormatName = argv[++i];
+      const std::string name = options.frameFormatName;
+      if (name == "fixed16") {
+        options.frameFormat = astro::FrameFormat::Fixed16;
+      } else if (name == "half") {
+        options.frameFormat = astro::FrameFormat::Half;
+      } else if (name == "vertex") {
+        options.frameFormat = astro::FrameFormat::Vertex;
+      } else if (name != "float32") {
+        std::fprintf(stderr, "unknown frame format: %s\n", argv[i]);
+        return false;
+      }
+    } else {
+      std::fprintf(stderr,
+                   "usage: %s [--max-stars N] [--min-time-ms T] [--frame-stats] [--frame-format F]\n",
+                   argv[0]);
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    return 2;
+  }
+
+#if !defined(ASTRO_BENCH_BUILD_TYPE)
+#define ASTRO_BENCH_BUILD_TYPE ""
+#endif
+#if defined(NDEBUG)
+  constexpr bool kNdebug = true;
+#else
+  constexpr bool kNdebug = false;
+#endif
+  std::printf("{\n");
+  std::printf("  \"build\": {\"compiler\": \"%s\", \"build_type\": \"%s\", \"ndebug\": %s, "
+              "\"frame_stats\": %s, \"frame_format\": \"%s\"},\n",
+              __VERSION__,
+              ASTRO_BENCH_BUILD_TYPE,
+              kNdebug ? "true" : "false",
+              options.frameStats ? "true" : "false",
+              options.frameFormatName);
+  benchStages(options);
+  benchFrames(options);
+  std::printf("}\n");
+  return 0;
+}
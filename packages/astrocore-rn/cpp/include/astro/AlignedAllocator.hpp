@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+namespace astro {
+
+inline constexpr std::size_t kCacheLineSize = 64;
+
+// Allocator handing out cache-line aligned storage so SoA columns start on
+// their own line and can be loaded with aligned vector instructions.
+template <typename T, std::size_t Alignment = kCacheLineSize>
+struct AlignedAllocator {
+  using value_type = T;
+
+  template <typename U>
+  struct rebind {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() noexcept = default;
+
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+  T* allocate(std::size_t n) {
+    return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{Alignment}));
+  }
+
+  void deallocate(T* ptr, std::size_t) noexcept {
+    ::operator delete(ptr, std::align_val_t{Alignment});
+  }
+
+  template <typename U>
+  bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept {
+    return true;
+  }
+};
+
+}  // namespace astro
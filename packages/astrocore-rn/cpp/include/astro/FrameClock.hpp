@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace astro {
+
+// Paces the background frame loop. Platform layers can drive it from vsync
+// (Choreographer, CADisplayLink); tests use ManualFrameClock.
+class FrameClock {
+ public:
+  virtual ~FrameClock() = default;
+
+  // Blocks until the next frame is due and reports its time in Unix
+  // milliseconds. Returns false once stop() has been called.
+  virtual bool wait(std::int64_t& unixMs) = 0;
+  // Makes the pending or next wait() return without waiting for the
+  // schedule, e.g. because a new pose arrived. Thread-safe.
+  virtual void wake() = 0;
+  // Ends the current and every later wait(). Thread-safe.
+  virtual void stop() = 0;
+};
+
+// Ticks at a fixed rate on steady_clock and stamps frames with the system
+// clock. A rate <= 0 only ticks on wake().
+class SteadyFrameClock final : public FrameClock {
+ public:
+  explicit SteadyFrameClock(double rateHz);
+
+  bool wait(std::int64_t& unixMs) override;
+  void wake() override;
+  void stop() override;
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable changed_;
+  std::chrono::steady_clock::duration period_;
+  std::chrono::steady_clock::time_point next_;
+  bool woken_{false};
+  bool stopped_{false};
+};
+
+// Ticks only when told to. Driven by platform vsync callbacks on device and
+// by the test itself on Linux; ticks that arrive faster than frames are
+// computed are coalesced into the latest.
+class ManualFrameClock final : public FrameClock {
+ public:
+  // Requests a frame at `unixMs`.
+  void tick(std::int64_t unixMs);
+
+  bool wait(std::int64_t& unixMs) override;
+  // Requests a frame at the last ticked time.
+  void wake() override;
+  void stop() override;
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable changed_;
+  std::int64_t unixMs_{0};
+  bool pending_{false};
+  bool stopped_{false};
+};
+
+}  // namespace astro
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "ProjectConfig.hpp"
+
+namespace astro {
+
+// ASTRO_FRAME_STATS=0 removes the timers and cull counters from the frame
+// path altogether; otherwise they run only while EngineConfig::recordFrameStats
+// is set.
+inline constexpr bool kFrameStatsCompiled = ASTRO_FRAME_STATS != 0;
+
+// Consecutive parts of one frame. Rotation, refraction and projection run
+// fused per star in the projection kernel and are timed together as Project.
+enum class FrameStage : std::uint8_t {
+  Sidereal,   // equatorial -> horizontal rotation (cached between frames)
+  Transform,  // pose rotation and per-frame kernel constants
+  Cull,       // sky-index query
+  Project,    // rotation, refraction and screen projection of every star
+  Commit,     // merging worker output, encoding and publishing the slot
+  Total,
+};
+inline constexpr std::size_t kFrameStageCount = 6;
+
+// Where each catalog star ended up in one frame. They add up to the catalog
+// size unless the frame hit the ring-buffer capacity.
+enum class FrameCounter : std::uint8_t {
+  TileCulled,    // skipped by the sky index without being looked at
+  Faint,         // past the limiting magnitude
+  BelowHorizon,
+  BehindCamera,
+  OffScreen,
+  Emitted,
+};
+inline constexpr std::size_t kFrameCounterCount = 6;
+
+const char* frameStageName(FrameStage stage);
+const char* frameCounterName(FrameCounter counter);
+
+// Measurements of one frame; Total is filled in by FrameStatsRecorder.
+struct FrameSample {
+  std::array<float, kFrameStageCount> stageMicros{};
+  std::array<std::uint32_t, kFrameCounterCount> counters{};
+};
+
+struct Percentiles {
+  double p50{0.0};
+  double p95{0.0};
+  double p99{0.0};
+};
+
+struct FrameStats {
+  // Frames recorded since the last reset, and how many of the latest the
+  // percentiles cover.
+  std::uint64_t frames{0};
+  std::size_t window{0};
+  std::array<Percentiles, kFrameStageCount> stageMicros{};
+  std::array<Percentiles, kFrameCounterCount> counters{};
+  FrameSample last{};
+};
+
+// Rolling window over the latest kWindow frames. Recording is a couple of
+// stores; the percentiles are only worked out by snapshot(). Not
+// thread-safe.
+class FrameStatsRecorder {
+ public:
+  static constexpr std::size_t kWindow = 256;
+
+  void record(FrameSample sample);
+  FrameStats snapshot() const;
+  void reset();
+
+ private:
+  std::array<FrameSample, kWindow> samples_{};
+  std::uint64_t frames_{0};
+};
+
+}  // namespace astro
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "types.hpp"
+
+namespace astro {
+
+// The latest device orientations with their sensor timestamps, so a frame
+// can be drawn with the pose expected at the moment it reaches the screen
+// rather than the last one measured. Not thread-safe.
+class PoseHistory {
+ public:
+  static constexpr std::size_t kCapacity = 32;
+
+  // Adds a sample at `unixMs`. A sample older than the newest is dropped;
+  // one at the same time replaces it.
+  void push(double unixMs, const PoseQuat& pose);
+  // Orientation at `unixMs`. Between two samples it is slerped; past the
+  // newest it is extrapolated at the angular velocity of the last two
+  // samples, for at most `maxLeadMs`; before the oldest it is the oldest.
+  // Returns false when there are no samples.
+  bool poseAt(double unixMs, double maxLeadMs, PoseQuat& pose) const;
+  void clear();
+
+  std::size_t size() const {
+    return count_;
+  }
+  bool empty() const {
+    return count_ == 0;
+  }
+
+ private:
+  struct Sample {
+    double unixMs{0.0};
+    PoseQuat pose{};
+  };
+
+  // The i-th oldest sample.
+  const Sample& at(std::size_t i) const;
+
+  std::array<Sample, kCapacity> samples_{};
+  std::size_t next_{0};
+  std::size_t count_{0};
+};
+
+}  // namespace astro
@@ -15,3 +15,23 @@
 #ifndef ASTRO_RINGBUFFER_STRIDE
 #define ASTRO_RINGBUFFER_STRIDE 4
 #endif
+
+#ifndef ASTRO_MAX_WORKER_THREADS
+#define ASTRO_MAX_WORKER_THREADS 8
+#endif
+
+#ifndef ASTRO_SKY_INDEX_LEVELS
+#define ASTRO_SKY_INDEX_LEVELS 4
+#endif
+
+#ifndef ASTRO_FRAME_STATS
+#define ASTRO_FRAME_STATS 1
+#endif
+
+#ifndef ASTRO_TRACE
+#define ASTRO_TRACE 1
+#endif
+
+#ifndef ASTRO_TRACE_EVENTS
+#define ASTRO_TRACE_EVENTS 16384
+#endif
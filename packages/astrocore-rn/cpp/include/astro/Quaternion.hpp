@@ -47,6 +47,45 @@ inline Vec3 normalize(const Vec3& v) {
   return v * (1.0 / len);
 }
 
+struct Mat3 {
+  double m[3][3]{{1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, 1.0}};
+
+  Vec3 row(int r) const {
+    return {m[r][0], m[r][1], m[r][2]};
+  }
+
+  Vec3 column(int c) const {
+    return {m[0][c], m[1][c], m[2][c]};
+  }
+
+  Mat3 transposed() const {
+    Mat3 t;
+    for (int r = 0; r < 3; ++r) {
+      for (int c = 0; c < 3; ++c) {
+        t.m[r][c] = m[c][r];
+      }
+    }
+    return t;
+  }
+};
+
+inline Vec3 operator*(const Mat3& a, const Vec3& v) {
+  return {
+      a.m[0][0] * v.x + a.m[0][1] * v.y + a.m[0][2] * v.z,
+      a.m[1][0] * v.x + a.m[1][1] * v.y + a.m[1][2] * v.z,
+      a.m[2][0] * v.x + a.m[2][1] * v.y + a.m[2][2] * v.z};
+}
+
+inline Mat3 operator*(const Mat3& a, const Mat3& b) {
+  Mat3 out;
+  for (int r = 0; r < 3; ++r) {
+    for (int c = 0; c < 3; ++c) {
+      out.m[r][c] = a.m[r][0] * b.m[0][c] + a.m[r][1] * b.m[1][c] + a.m[r][2] * b.m[2][c];
+    }
+  }
+  return out;
+}
+
 class Quaternion {
  public:
   Quaternion() = default;
@@ -68,12 +107,67 @@ class Quaternion {
     return Quaternion(w_, -x_, -y_, -z_).normalized();
   }
 
+  PoseQuat toPose() const {
+    return {w_, x_, y_, z_};
+  }
+
+  double dot(const Quaternion& other) const {
+    return w_ * other.w_ + x_ * other.x_ + y_ * other.y_ + z_ * other.z_;
+  }
+
+  // Constant angular velocity path through unit quaternions `a` (t = 0) and
+  // `b` (t = 1), taking the shorter arc. Values of t outside [0, 1]
+  // extrapolate along the same rotation.
+  static Quaternion slerp(const Quaternion& a, const Quaternion& b, double t) {
+    double cosTheta = a.dot(b);
+    const double sign = cosTheta < 0.0 ? -1.0 : 1.0;
+    cosTheta *= sign;
+    double wa = 1.0 - t;
+    double wb = t;
+    // Nearly parallel: the normalized lerp is exact to rounding.
+    if (cosTheta < 0.9999) {
+      const double theta = std::acos(cosTheta);
+      const double sinTheta = std::sin(theta);
+      wa = std::sin(wa * theta) / sinTheta;
+      wb = std::sin(wb * theta) / sinTheta;
+    }
+    wa *= sign;
+    return Quaternion(wa * a.w_ + wb * b.w_, wa * a.x_ + wb * b.x_, wa * a.y_ + wb * b.y_, wa * a.z_ + wb * b.z_)
+        .normalized();
+  }
+
   Vec3 rotate(const Vec3& v) const {
     Quaternion p(0.0, v.x, v.y, v.z);
     Quaternion result = (*this) * p * this->inverse();
     return {result.x_, result.y_, result.z_};
   }
 
+  // Rotation matrix equivalent to rotate() for a unit quaternion.
+  Mat3 toMatrix() const {
+    const Quaternion q = normalized();
+    const double xx = q.x_ * q.x_;
+    const double yy = q.y_ * q.y_;
+    const double zz = q.z_ * q.z_;
+    const double xy = q.x_ * q.y_;
+    const double xz = q.x_ * q.z_;
+    const double yz = q.y_ * q.z_;
+    const double wx = q.w_ * q.x_;
+    const double wy = q.w_ * q.y_;
+    const double wz = q.w_ * q.z_;
+
+    Mat3 out;
+    out.m[0][0] = 1.0 - 2.0 * (yy + zz);
+    out.m[0][1] = 2.0 * (xy - wz);
+    out.m[0][2] = 2.0 * (xz + wy);
+    out.m[1][0] = 2.0 * (xy + wz);
+    out.m[1][1] = 1.0 - 2.0 * (xx + zz);
+    out.m[1][2] = 2.0 * (yz - wx);
+    out.m[2][0] = 2.0 * (xz - wy);
+    out.m[2][1] = 2.0 * (yz + wx);
+    out.m[2][2] = 1.0 - 2.0 * (xx + yy);
+    return out;
+  }
+
   Quaternion operator*(const Quaternion& other) const {
     return Quaternion(
         w_ * other.w_ - x_ * other.x_ - y_ * other.y_ - z_ * other.z_,
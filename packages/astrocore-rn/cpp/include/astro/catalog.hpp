@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "AlignedAllocator.hpp"
+#include "catalog_file.hpp"
+#include "sky_index.hpp"
+#include "types.hpp"
+
+namespace astro {
+
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+class MappedFile;
+
+// (raDeg, decDeg, mag, hip) float records, the layout the JS bindings upload.
+// They carry no color; see updateColors().
+inline constexpr std::size_t kPackedStarFloats = 4;
+
+// Structure-of-arrays star storage. Each star is kept as a J2000 unit vector
+// split across x/y/z columns, next to its magnitude, Hipparcos id and B-V, so the
+// frame loop only streams the columns it actually reads. Stars are stored in
+// sky-index leaf order, not input order. The columns are either owned or, after
+// load(), read in place from a memory-mapped catalog file.
+class StarCatalog {
+ public:
+  StarCatalog() = default;
+  StarCatalog(StarCatalog&&) noexcept = default;
+  StarCatalog& operator=(StarCatalog&&) noexcept = default;
+  StarCatalog(const StarCatalog&) = delete;
+  StarCatalog& operator=(const StarCatalog&) = delete;
+
+  void assign(std::span<const StarIn> stars, const CatalogOptions& options = {});
+  // assign() reading packed records in place.
+  void assignPacked(std::span<const float> records, const CatalogOptions& options = {});
+  // Replaces the stars at input positions [first, first + n) (file order for
+  // a mapped catalog, which is copied into owned storage first). Stars that
+  // stay in their leaf only re-sort and refit that leaf; a star crossing
+  // leaves re-sorts the whole storage from the columns. A NaN bv, which
+  // packed records always carry, keeps the star's color. Returns false when
+  // the range runs past the catalog.
+  bool update(std::size_t first, std::span<const StarIn> stars);
+  bool updatePacked(std::size_t first, std::span<const float> records);
+  // Sets the B-V of the stars at input positions [first, first + n), NaN
+  // for unknown. Returns false when the range runs past the catalog.
+  bool updateColors(std::size_t first, std::span<const float> bv);
+  // Storage slot of the star at input position `i`.
+  std::uint32_t slotOf(std::size_t i) const;
+  // Maps a catalog file (see catalog_file.hpp). On failure the current
+  // contents are kept.
+  CatalogFileStatus load(const std::string& path);
+  void clear();
+
+  std::size_t size() const noexcept {
+    return size_;
+  }
+  bool empty() const noexcept {
+    return size_ == 0;
+  }
+
+  const float* x() const noexcept {
+    return x_;
+  }
+  const float* y() const noexcept {
+    return y_;
+  }
+  const float* z() const noexcept {
+    return z_;
+  }
+  const float* mag() const noexcept {
+    return mag_;
+  }
+  const std::int32_t* hip() const noexcept {
+    return hip_;
+  }
+  // Null for a mapped file without a color section.
+  const float* bv() const noexcept {
+    return bv_;
+  }
+  // True when the columns live in a mapped file rather than owned memory.
+  bool mapped() const noexcept {
+    return file_ != nullptr;
+  }
+
+  const SkyIndex& index() const noexcept {
+    return index_;
+  }
+  bool sortedByMagnitude() const noexcept {
+    return sortedByMagnitude_;
+  }
+
+  // Storage ranges that may hold stars inside both cones and no fainter
+  // than `limitingMag`. When the catalog is magnitude sorted the ranges are
+  // already trimmed at the limit; otherwise only whole tiles are dropped.
+  void collect(const SkyCone& view,
+               const SkyCone& horizon,
+               double limitingMag,
+               std::vector<StarRange>& out) const;
+
+ private:
+  template <typename Source>
+  void assignFrom(const Source& stars, const CatalogOptions& options);
+  template <typename Source>
+  bool updateFrom(std::size_t first, const Source& stars);
+  // Sorts the owned columns into leaf (and magnitude) order and rebuilds the index.
+  void arrange(int levels);
+  // Reorders slots [begin, begin + order.size()) so slot begin + k takes order[k].
+  void permuteSlots(std::uint32_t begin, std::span<const std::uint32_t> order);
+  void makeOwned();
+  void pointAtOwned();
+
+  // Column views handed out by the accessors, pointing either at the owned
+  // vectors below or into file_.
+  const float* x_{nullptr};
+  const float* y_{nullptr};
+  const float* z_{nullptr};
+  const float* mag_{nullptr};
+  const std::int32_t* hip_{nullptr};
+  const float* bv_{nullptr};
+  std::size_t size_{0};
+
+  AlignedVector<float> ownedX_;
+  AlignedVector<float> ownedY_;
+  AlignedVector<float> ownedZ_;
+  AlignedVector<float> ownedMag_;
+  AlignedVector<std::int32_t> ownedHip_;
+  AlignedVector<float> ownedBv_;
+  std::shared_ptr<const MappedFile> file_;
+  // Input position of the star in each slot, and the inverse. Empty while
+  // the catalog is mapped, where both are the identity.
+  std::vector<std::uint32_t> inputOf_;
+  std::vector<std::uint32_t> slotOf_;
+
+  SkyIndex index_;
+  bool sortedByMagnitude_{false};
+};
+
+}  // namespace astro
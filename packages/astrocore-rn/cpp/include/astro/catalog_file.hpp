@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace astro {
+
+class StarCatalog;
+
+// Binary star catalog that StarCatalog::load maps and reads in place.
+//
+// Every field is little-endian. A CatalogFileHeader is followed by sections
+// at the 64-byte aligned offsets it records:
+//   x, y, z  float32[starCount]  J2000 unit vector
+//   mag      float32[starCount]
+//   hip      int32[starCount]
+//   bv       float32[starCount]  optional (version 2), B-V color index
+//   tiles    SkyTile[tileCount]  optional, every level of the sky index
+// Stars are stored exactly as StarCatalog keeps them in memory: in sky-index
+// leaf order for indexLevels, brightest first inside each leaf when
+// kCatalogFileSortedByMagnitude is set. Without the tile section the index
+// is rebuilt from the columns at load time. Version 1 files end the header
+// before bvOffset and load without colors.
+inline constexpr char kCatalogFileMagic[8] = {'A', 'S', 'T', 'R', 'O', 'C', 'A', 'T'};
+inline constexpr std::uint32_t kCatalogFileVersion = 2;
+inline constexpr std::uint32_t kCatalogFileSortedByMagnitude = 1u << 0;
+
+struct CatalogFileHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t flags;
+  std::uint64_t starCount;
+  std::int32_t indexLevels;
+  // Zero when the file carries no tile index.
+  std::uint32_t tileCount;
+  std::uint64_t xOffset;
+  std::uint64_t yOffset;
+  std::uint64_t zOffset;
+  std::uint64_t magOffset;
+  std::uint64_t hipOffset;
+  std::uint64_t tilesOffset;
+  // Zero when the file carries no colors.
+  std::uint64_t bvOffset;
+};
+static_assert(sizeof(CatalogFileHeader) == 88, "catalog file header layout is fixed");
+inline constexpr std::size_t kCatalogFileHeaderV1Bytes = 80;
+
+enum class CatalogFileStatus {
+  Ok,
+  OpenFailed,
+  BadMagic,
+  UnsupportedVersion,
+  Truncated,
+  Corrupt,
+  WriteFailed,
+};
+
+const char* describe(CatalogFileStatus status);
+
+// Writes `catalog` in the layout above, with its tile index unless
+// `includeTiles` is false.
+CatalogFileStatus writeCatalogFile(const std::string& path, const StarCatalog& catalog, bool includeTiles = true);
+
+}  // namespace astro
@@ -1,15 +1,34 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <span>
+#include <string>
+#include <thread>
 #include <vector>
 
+#include "FrameStats.hpp"
+#include "PoseHistory.hpp"
 #include "ProjectConfig.hpp"
+#include "Quaternion.hpp"
+#include "catalog.hpp"
+#include "transform.hpp"
 #include "types.hpp"
 
 namespace astro {
 
+class FrameClock;
 class RingBuffer;
+class WorkerPool;
+struct CatalogColumns;
+struct CullCounters;
+struct ProjectionParams;
+
+// Every method may be called from any thread; state changes serialize with
+// frame computation. The ring buffer's consumer side (acquire/release) is for
+// a single reader thread.
+// Doubles per pose sample in a batch: unixMs, then w, x, y, z.
+inline constexpr std::size_t kPoseSampleDoubles = 5;
 
 class AstroEngine {
  public:
@@ -18,10 +37,57 @@ class AstroEngine {
 
   void setConfig(const EngineConfig& config);
   void setObserver(const Observer& observer);
-  void setStars(std::span<const StarIn> stars);
+  void setStars(std::span<const StarIn> stars, const CatalogOptions& options = {});
+  // setStars() from kPackedStarFloats records, read in place.
+  void setPackedStars(std::span<const float> records, const CatalogOptions& options = {});
+  // Patches the stars at input positions [first, first + n); see
+  // StarCatalog::update. Returns false when the range runs past the catalog.
+  bool updateStars(std::size_t first, std::span<const StarIn> stars);
+  bool updatePackedStars(std::size_t first, std::span<const float> records);
+  // B-V of the stars at input positions [first, first + n), for
+  // FrameFormat::Vertex; see StarCatalog::updateColors.
+  bool setStarColors(std::size_t first, std::span<const float> bv);
+  // Stars in the current catalog.
+  std::size_t starCount();
+  // Replaces the catalog with a memory-mapped catalog file, used in place.
+  CatalogFileStatus loadCatalog(const std::string& path);
+  // Per-frame override of EngineConfig::limitingMag.
+  void setLimitingMag(double limitingMag);
+  // Sets the pose used until the next one and forgets the pose history.
   void updatePose(const PoseQuat& pose);
+  // Sets the pose and records it, measured at `unixMs` (the frame clock's
+  // time base), for frames that predict the pose at display time.
+  void pushPose(double unixMs, const PoseQuat& pose);
 
+  // Projects the catalog into a free ring-buffer slot and publishes it.
+  // Returns the visible count; 0 also when the reader has every spare slot
+  // pinned and the frame is dropped.
   std::size_t computeFrame(double jd);
+  // updatePose() and computeFrame() under one lock, for callers that sample
+  // the pose right before each frame.
+  std::size_t computeFrame(double jd, const PoseQuat& pose);
+  // pushPose() for every (unixMs, w, x, y, z) record of `samples`, oldest
+  // first, then a frame at the newest sample's time and pose, under one
+  // lock. The samples stay in the history for later predicted frames.
+  std::size_t computeFrame(std::span<const double> samples);
+  // computeFrame() with the pose predicted from the pushPose() history for
+  // `displayUnixMs`, when the frame will be on screen. Without a history
+  // the latest pose is used.
+  std::size_t computeFrame(double jd, double displayUnixMs);
+  // Publishes an empty frame.
+  void clearFrame();
+
+  // Computes frames on a background thread whenever `clock` ticks, and also
+  // on every updatePose when `framePerPose` is set. computeFrame stays
+  // usable and takes turns with the loop. Restarting replaces the clock.
+  void startFrameLoop(std::shared_ptr<FrameClock> clock, bool framePerPose = false);
+  void stopFrameLoop();
+  bool frameLoopRunning() const;
+
+  // Percentiles over the latest frames rendered with
+  // EngineConfig::recordFrameStats set; empty when compiled out.
+  FrameStats frameStats();
+  void resetFrameStats();
 
   const RingBuffer& ringBuffer() const noexcept {
     return *ringBuffer_;
@@ -31,13 +97,63 @@ class AstroEngine {
   }
 
  private:
+  struct SiderealCache {
+    double jd{0.0};
+    Mat3 equatorialToENU;
+    // Annual aberration in ENU; zero unless EngineConfig::apparentPlaces.
+    Vec3 aberrationENU;
+    bool valid{false};
+  };
+  struct ApparentCache {
+    double jd{0.0};
+    transform::ApparentFrame frame;
+    bool valid{false};
+  };
+
+  std::size_t renderFrame(double jd, const PoseQuat& pose);
+  PoseQuat poseAt(double unixMs) const;
+  // Stops the clock and joins the frame thread; loopMutex_ must be held.
+  void joinFrameLoop();
+  const Mat3& siderealRotation(double jd);
+  double effectiveLimitingMag() const;
+  std::size_t projectStars(const ProjectionParams& params,
+                           const CatalogColumns& columns,
+                           std::span<const StarRange> ranges,
+                           float* out,
+                           std::size_t capacity,
+                           double& mergeMicros);
+
   EngineConfig config_;
   Observer observer_;
   PoseQuat pose_;
-  std::vector<StarIn> catalog_;
-  std::vector<StarOut> output_;
+  PoseHistory poseHistory_;
+  SiderealCache siderealCache_;
+  ApparentCache apparentCache_;
+  // Rebuilt only when the observer's ambient conditions change.
+  transform::RefractionTable refraction_;
+  StarCatalog catalog_;
   std::unique_ptr<RingBuffer> ringBuffer_;
+  std::unique_ptr<WorkerPool> workers_;
+  std::vector<AlignedVector<float>> staging_;
+  // Float records of a frame in a compact FrameFormat, before encoding.
+  AlignedVector<float> records_;
+  // 0, 1, 2, ...: projected in place of the ids so Vertex records name the
+  // catalog slot their color and id are looked up from.
+  AlignedVector<std::int32_t> slotNumbers_;
+  std::vector<std::size_t> sliceCounts_;
+  std::vector<StarRange> ranges_;
+  std::vector<CullCounters> sliceCulled_;
+  FrameStatsRecorder stats_;
   bool configReady_{false};
+
+  // Guards everything above against the frame loop.
+  std::mutex mutex_;
+  std::shared_ptr<FrameClock> clock_;
+  bool framePerPose_{false};
+  // Serializes starting and stopping the loop; taken before mutex_ and never
+  // by the loop itself, so joining under it cannot deadlock.
+  mutable std::mutex loopMutex_;
+  std::thread frameThread_;
 };
 
 }  // namespace astro
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Quaternion.hpp"
+
+namespace astro {
+
+// Contiguous run of catalog storage indices [begin, end).
+struct StarRange {
+  std::uint32_t begin{0};
+  std::uint32_t end{0};
+};
+
+// Cone on the unit sphere, used for both the view frustum and the region
+// above the horizon.
+struct SkyCone {
+  Vec3 axis{0.0, 0.0, 1.0};
+  double radiusRad{0.0};
+};
+
+// Node of the sky quadtree: a bounding cone around its stars, their
+// brightest magnitude, and the storage range they occupy.
+struct SkyTile {
+  float axis[3]{0.0f, 0.0f, 0.0f};
+  float radiusRad{0.0f};
+  float cosRadius{1.0f};
+  float sinRadius{0.0f};
+  float minMag{0.0f};
+  float maxMag{0.0f};
+  std::uint32_t begin{0};
+  std::uint32_t end{0};
+
+  bool empty() const noexcept {
+    return begin == end;
+  }
+};
+// Tiles are stored verbatim in catalog files.
+static_assert(sizeof(SkyTile) == 40, "SkyTile layout is part of the catalog file format");
+
+// Hierarchical cube-map index over J2000 unit vectors. Each cube face is a
+// quadtree whose leaves are numbered in Morton order, so once the catalog is
+// sorted by leaf every node at every level owns one contiguous star range.
+class SkyIndex {
+ public:
+  static constexpr int kMaxLevels = 10;
+
+  // Leaf of the quadtree at `levels` subdivisions containing a direction.
+  static std::uint32_t leafOf(int levels, float x, float y, float z);
+  static std::size_t leafCount(int levels) {
+    return std::size_t{6} << (2 * levels);
+  }
+  // Nodes across every level, root faces included.
+  static std::size_t tileCount(int levels) {
+    return levelOffset(levels + 1);
+  }
+
+  // Builds every level from catalog columns already ordered by leaf.
+  // `levels` must not exceed kMaxLevels.
+  // `leafBegin` holds leafCount(levels) + 1 prefix offsets.
+  void build(int levels,
+             std::span<const std::uint32_t> leafBegin,
+             const float* x,
+             const float* y,
+             const float* z,
+             const float* mag);
+  // Recomputes the bounds and magnitude range of the given leaves (sorted,
+  // unique) and their ancestors after their stars changed in place.
+  void refit(std::span<const std::uint32_t> leaves,
+             const float* x,
+             const float* y,
+             const float* z,
+             const float* mag);
+  // Adopts every level of a previously built index, e.g. one stored in a
+  // catalog file. Fails unless each level partitions [0, starCount) in order.
+  bool assign(int levels, std::span<const SkyTile> tiles, std::size_t starCount);
+  void clear();
+
+  // Appends the storage ranges of every tile that may intersect both cones
+  // and holds a star no fainter than `limitingMag`. Adjacent ranges are
+  // merged. When `sortedMag` is non-null each leaf is taken to be ordered
+  // brightest first and is cut at the limit with a binary search.
+  void collect(const SkyCone& view,
+               const SkyCone& horizon,
+               double limitingMag,
+               const float* sortedMag,
+               std::vector<StarRange>& out) const;
+
+  int levels() const noexcept {
+    return levels_;
+  }
+  std::span<const SkyTile> level(int l) const;
+  std::span<const SkyTile> tiles() const noexcept {
+    return tiles_;
+  }
+
+ private:
+  static std::size_t levelOffset(int l) {
+    return 2 * ((std::size_t{1} << (2 * l)) - 1);
+  }
+
+  // Bounds and magnitude range of one node from its stars or children.
+  void fit(int l, std::size_t node, const float* x, const float* y, const float* z, const float* mag);
+
+  int levels_{0};
+  std::vector<SkyTile> tiles_;
+};
+
+}  // namespace astro
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "ProjectConfig.hpp"
+
+// Span recording for Chrome trace-event / Perfetto timelines.
+//
+// Spans go into a process-wide ring of ASTRO_TRACE_EVENTS entries, allocated
+// by the first start() and overwritten oldest-first once full. Recording a
+// span is an atomic increment and a handful of relaxed stores: no locks and
+// no allocation, so it is safe from the frame loop, worker threads and JSI
+// calls alike. Names and categories must be string literals; only the
+// pointers are kept. ASTRO_TRACE=0 compiles every span away.
+namespace astro::trace {
+
+inline constexpr bool kCompiled = ASTRO_TRACE != 0;
+
+namespace detail {
+inline std::atomic<bool> recording{false};
+}  // namespace detail
+
+// Starts recording; spans from earlier sessions are dropped.
+void start();
+void stop();
+
+inline bool recording() {
+  return detail::recording.load(std::memory_order_acquire);
+}
+
+// Labels the calling thread in dumps, e.g. "astro-worker".
+void setThreadName(const char* name);
+
+std::uint64_t nowNanos();
+void record(const char* category, const char* name, std::uint64_t beginNanos, std::uint64_t endNanos,
+            std::int64_t count);
+
+// Writes the spans recorded since start() as Chrome trace-event JSON. Safe
+// while recording; spans overwritten during the dump are left out. Returns
+// false if the file cannot be written.
+bool dump(const std::string& path);
+
+// Records [construction, destruction) as one span while recording is on.
+class Span {
+ public:
+  Span(const char* category, const char* name) : category_(category), name_(name) {
+    if constexpr (kCompiled) {
+      if (recording()) {
+        beginNanos_ = nowNanos();
+      }
+    }
+  }
+
+  ~Span() {
+    if constexpr (kCompiled) {
+      if (beginNanos_ != 0) {
+        record(category_, name_, beginNanos_, nowNanos(), count_);
+      }
+    }
+  }
+
+  Span(const Span&) = delete;
+  Span& operator=(const Span&) = delete;
+
+  // Attached to the span as args.count, e.g. stars projected.
+  void setCount(std::int64_t count) {
+    count_ = count;
+  }
+
+ private:
+  const char* category_;
+  const char* name_;
+  std::uint64_t beginNanos_{0};
+  std::int64_t count_{-1};
+};
+
+}  // namespace astro::trace
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <cstdint>
+#include <limits>
+
+#include "ProjectConfig.hpp"
 
 namespace astro {
 
@@ -8,6 +11,10 @@ struct Observer {
   double latDeg{0.0};
   double lonDeg{0.0};
   double elevationM{0.0};
+  // Ambient conditions for refraction. A pressure <= 0 is derived from
+  // elevationM with the standard atmosphere.
+  double pressureHPa{0.0};
+  double temperatureC{10.0};
 };
 
 struct Horizontal {
@@ -27,11 +34,22 @@ struct ScreenSize {
   int height{0};
 };
 
+// Per-frame screen constants derived from EngineConfig, hoisted out of the star loop.
+struct ScreenProjection {
+  double halfWidth{0.0};
+  double halfHeight{0.0};
+  double focalLength{0.0};
+  float width{0.0f};
+  float height{0.0f};
+};
+
 struct StarIn {
   double raDeg{0.0};
   double decDeg{0.0};
   double mag{0.0};
   int hip{0};
+  // B-V color index; NaN when unknown, which draws white.
+  double bv{std::numeric_limits<double>::quiet_NaN()};
 };
 
 struct StarOut {
@@ -42,10 +60,76 @@ struct StarOut {
   bool visible{false};
 };
 
+// How each frame's visible stars are stored in the ring buffer.
+enum class FrameFormat : std::uint8_t {
+  // (x, y, mag, hip) float records, 16 bytes per star. HIP ids above 2^24
+  // are rounded.
+  Float32,
+  // Columns of int16 (x, y) in 1/8 px, uint8 magnitude in 1/16 mag steps
+  // from -2, and uint32 id: 9 bytes per star. Coordinates reach 4095 px and
+  // magnitudes 13.9.
+  Fixed16,
+  // Columns of half-float (x, y), half-float magnitude and uint32 id: 10
+  // bytes per star. Coordinates above 2048 px lose sub-pixel precision.
+  Half,
+  // Interleaved (x, y, size) float and packed color vertices, ready for a
+  // point draw call, plus a column of uint32 ids: 20 bytes per star. Size
+  // and alpha follow EngineConfig::pointStyle, the color the star's B-V.
+  Vertex,
+};
+
+// Point size (px) and opacity of FrameFormat::Vertex as linear functions of
+// magnitude, each clamped to its range.
+struct PointStyle {
+  double sizeAtMag0{6.0};
+  double sizePerMag{0.75};
+  double minSize{1.0};
+  double maxSize{8.0};
+  double alphaAtMag0{1.0};
+  double alphaPerMag{0.1};
+  double minAlpha{0.2};
+};
+
 struct EngineConfig {
   double fovDeg{60.0};
   ScreenSize screen{};
   bool applyRefraction{true};
+  // Threads sharing computeFrame, including the caller. Values <= 1 keep the
+  // frame on the calling thread; larger values start a persistent pool.
+  int workerThreads{1};
+  // Stars fainter than this are skipped. When limitingMagFollowsFov is set
+  // the limit describes the default field of view and deepens by
+  // 5 * log10(ASTRO_DEFAULT_FOV_DEG / fovDeg) as the view narrows.
+  double limitingMag{std::numeric_limits<double>::infinity()};
+  bool limitingMagFollowsFov{false};
+  // Sidereal drift tolerated before the equatorial->horizontal rotation is
+  // rebuilt; frames inside it only redo the pose rotation. The default
+  // (0.001 deg, about 0.24 s of Earth rotation) is far below a pixel.
+  double siderealToleranceDeg{0.001};
+  // Take catalog places as J2000 (ICRS) and draw apparent places of date,
+  // with frame bias, precession, nutation and annual aberration (see
+  // transform::apparentFrame). Off, RA/Dec are drawn as coordinates of date.
+  bool apparentPlaces{false};
+  // Julian days the date may move before the apparent frame is rebuilt. Its
+  // terms drift by well under an arcsecond a day.
+  double apparentFrameIntervalDays{1.0};
+  // Record per-frame stage timings and cull counters (see FrameStats.hpp).
+  bool recordFrameStats{false};
+  FrameFormat frameFormat{FrameFormat::Float32};
+  PointStyle pointStyle{};
+  // Furthest the pose is extrapolated past the newest timestamped sample
+  // (see AstroEngine::pushPose).
+  double maxPoseLeadMs{50.0};
+  // Time from a frame-loop tick to the frame reaching the screen; the loop
+  // predicts the pose for the tick plus this.
+  double displayLatencyMs{0.0};
+};
+
+struct CatalogOptions {
+  // Order stars brightest-first inside each sky tile so a limiting magnitude
+  // ends the scan of a tile early.
+  bool sortByMagnitude{true};
+  int indexLevels{ASTRO_SKY_INDEX_LEVELS};
 };
 
 }  // namespace astro
@@ -1,12 +1,38 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
 #include "Quaternion.hpp"
 #include "types.hpp"
 
 namespace astro::vector {
 
+Vec3 equatorialToUnit(double raDeg, double decDeg);
 Vec3 horizontalToENU(const Horizontal& horizontal);
 Vec3 rotateToDevice(const Vec3& enu, const Quaternion& orientation);
+ScreenProjection makeScreenProjection(const EngineConfig& config);
+bool projectToScreen(const Vec3& deviceVec, const ScreenProjection& projection, float& outX, float& outY);
 bool projectToScreen(const Vec3& deviceVec, const EngineConfig& config, float& outX, float& outY);
 
+// Batch forms over structure-of-arrays spans, converting the first n
+// elements, n being the length of the shortest span, with the same results
+// as the one-star forms (see transform.hpp).
+void horizontalToENU(std::span<const double> altRad,
+                     std::span<const double> azRad,
+                     std::span<double> east,
+                     std::span<double> north,
+                     std::span<double> up);
+// Sets visible[i] to 1 for the directions that land on screen and returns
+// how many did. Screen coordinates are written for every direction but only
+// mean something where visible[i] is set.
+std::size_t projectToScreen(std::span<const double> deviceX,
+                            std::span<const double> deviceY,
+                            std::span<const double> deviceZ,
+                            const ScreenProjection& projection,
+                            std::span<float> outX,
+                            std::span<float> outY,
+                            std::span<std::uint8_t> visible);
+
 }  // namespace astro::vector
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "catalog.hpp"
+#include "types.hpp"
+
+// Where every catalog star stands for every combination of observer and
+// time, without an AstroEngine: for precomputing "what is up" tables over
+// many sites and time steps. Results are indexed [time][observer][star],
+// stars in catalog input order.
+//
+// The grid is split into one task per (time, longitude) and spread over
+// GridOptions::threads. Within a task the stars are rotated to the local
+// meridian once and every observer at that longitude only adds its
+// latitude, so sites sharing a longitude share the sidereal work.
+namespace astro::visibility {
+
+struct GridOptions {
+  // Threads sharing the work, including the caller; 0 uses every core.
+  std::size_t threads{0};
+  // Refract altitudes for each observer's ambient conditions, as the engine
+  // does with EngineConfig::applyRefraction.
+  bool applyRefraction{true};
+  // Bitsets only: a star counts as visible at or above this altitude.
+  double minAltDeg{0.0};
+};
+
+// One bit per star for every (time, observer) row.
+struct Bitsets {
+  std::size_t times{0};
+  std::size_t observers{0};
+  std::size_t stars{0};
+  // 64-bit words per row; bit s % 64 of word s / 64 is star s.
+  std::size_t rowWords{0};
+  std::vector<std::uint64_t> words;
+
+  std::span<const std::uint64_t> row(std::size_t time, std::size_t observer) const {
+    return {words.data() + (time * observers + observer) * rowWords, rowWords};
+  }
+  bool visible(std::size_t time, std::size_t observer, std::size_t star) const {
+    return (row(time, observer)[star / 64] >> (star % 64) & 1u) != 0;
+  }
+};
+
+Bitsets computeBitsets(const StarCatalog& catalog,
+                       std::span<const Observer> observers,
+                       std::span<const double> jds,
+                       const GridOptions& options = {});
+
+// Floats computeAltAz() writes for the given grid: an (altRad, azRad) pair
+// per star, azimuth from north through east wrapped into [0, 2 pi].
+inline std::size_t altAzFloats(std::size_t times, std::size_t observers, std::size_t stars) {
+  return times * observers * stars * 2;
+}
+
+// Writes the packed (alt, az) grid into `altAz`. Returns false, writing
+// nothing, when it holds fewer than altAzFloats() floats.
+bool computeAltAz(const StarCatalog& catalog,
+                  std::span<const Observer> observers,
+                  std::span<const double> jds,
+                  std::span<float> altAz,
+                  const GridOptions& options = {});
+
+struct TrackOptions {
+  // Threads sharing the work, including the caller; 0 uses every core.
+  std::size_t threads{0};
+  // Samples between exact re-anchors of the incremental rotation.
+  std::size_t anchorInterval{64};
+};
+
+// Floats computeTracks() writes: an (east, north, up) unit vector per star
+// and sample.
+inline std::size_t trackFloats(std::size_t samples, std::size_t stars) {
+  return samples * stars * 3;
+}
+
+// Star trails for one observer: the unrefracted local East-North-Up
+// direction of every star at jd0 + k * dtDays for k in [0, samples),
+// indexed [sample][star], stars in catalog input order.
+//
+// Between samples the sky turns by a fixed angle about the celestial pole,
+// so each sample is the previous one times a precomputed step matrix: nine
+// multiply-adds per star and no trigonometry or sidereal time. Every
+// anchorInterval samples the directions are recomputed from the exact
+// sidereal time, which keeps single-precision drift below 1e-5 rad.
+// Returns false, writing nothing, when `enu` holds fewer than
+// trackFloats() floats.
+bool computeTracks(const StarCatalog& catalog,
+                   const Observer& observer,
+                   double jd0,
+                   double dtDays,
+                   std::size_t samples,
+                   std::span<float> enu,
+                   const TrackOptions& options = {});
+
+}  // namespace astro::visibility
@@ -1,15 +1,22 @@
 #include "AstroCoreHostObject.hpp"
 
 #include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <span>
 #include <memory>
+#include <optional>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 #include "RingBuffer.hpp"
+#include "astro/FrameClock.hpp"
 #include "astro/time.hpp"
+#include "astro/trace.hpp"
+#include "jsi_bindings.hpp"
 
 namespace astro::jsi {
 
@@ -17,119 +24,378 @@ namespace jsi = facebook::jsi;
 
 namespace {
 
-EngineConfig readEngineConfig(jsi::Runtime& rt, const jsi::Object& object) {
+FrameClockFactory& frameClockFactory() {
+  static FrameClockFactory factory;
+  return factory;
+}
+
+}  // namespace
+
+// Property names read from JS argument objects, interned once per runtime.
+struct PropNames {
+  explicit PropNames(jsi::Runtime& rt)
+      : w(name(rt, "w")),
+        x(name(rt, "x")),
+        y(name(rt, "y")),
+        z(name(rt, "z")),
+        latDeg(name(rt, "latDeg")),
+        lonDeg(name(rt, "lonDeg")),
+        elevationM(name(rt, "elevationM")),
+        pressureHPa(name(rt, "pressureHPa")),
+        temperatureC(name(rt, "temperatureC")),
+        fovDeg(name(rt, "fovDeg")),
+        width(name(rt, "width")),
+        height(name(rt, "height")),
+        applyRefraction(name(rt, "applyRefraction")),
+        workerThreads(name(rt, "workerThreads")),
+        limitingMag(name(rt, "limitingMag")),
+        limitingMagFollowsFov(name(rt, "limitingMagFollowsFov")),
+        siderealToleranceDeg(name(rt, "siderealToleranceDeg")),
+        apparentPlaces(name(rt, "apparentPlaces")),
+        apparentFrameIntervalDays(name(rt, "apparentFrameIntervalDays")),
+        recordFrameStats(name(rt, "recordFrameStats")),
+        frameRateHz(name(rt, "frameRateHz")),
+        frameOnPose(name(rt, "frameOnPose")),
+        frameFormat(name(rt, "frameFormat")),
+        pointStyle(name(rt, "pointStyle")),
+        maxPoseLeadMs(name(rt, "maxPoseLeadMs")),
+        displayLatencyMs(name(rt, "displayLatencyMs")),
+        sizeAtMag0(name(rt, "sizeAtMag0")),
+        sizePerMag(name(rt, "sizePerMag")),
+        minSize(name(rt, "minSize")),
+        maxSize(name(rt, "maxSize")),
+        alphaAtMag0(name(rt, "alphaAtMag0")),
+        alphaPerMag(name(rt, "alphaPerMag")),
+        minAlpha(name(rt, "minAlpha")),
+        sortByMagnitude(name(rt, "sortByMagnitude")),
+        raDeg(name(rt, "raDeg")),
+        decDeg(name(rt, "decDeg")),
+        mag(name(rt, "mag")),
+        hip(name(rt, "hip")),
+        bv(name(rt, "bv")),
+        buffer(name(rt, "buffer")),
+        byteOffset(name(rt, "byteOffset")),
+        length(name(rt, "length")),
+        constructor(name(rt, "constructor")),
+        constructorName(name(rt, "name")) {}
+
+  static jsi::PropNameID name(jsi::Runtime& rt, const char* ascii) {
+    return jsi::PropNameID::forAscii(rt, ascii);
+  }
+
+  jsi::PropNameID w, x, y, z;
+  jsi::PropNameID latDeg, lonDeg, elevationM, pressureHPa, temperatureC;
+  jsi::PropNameID fovDeg, width, height, applyRefraction, workerThreads, limitingMag, limitingMagFollowsFov,
+      siderealToleranceDeg, apparentPlaces, apparentFrameIntervalDays, recordFrameStats, frameRateHz, frameOnPose,
+      frameFormat, pointStyle, maxPoseLeadMs, displayLatencyMs;
+  jsi::PropNameID sizeAtMag0, sizePerMag, minSize, maxSize, alphaAtMag0, alphaPerMag, minAlpha;
+  jsi::PropNameID sortByMagnitude;
+  jsi::PropNameID raDeg, decDeg, mag, hip, bv;
+  jsi::PropNameID buffer, byteOffset, length, constructor, constructorName;
+};
+
+// Every JSI value a host object caches, so release() can drop them all
+// before the runtime goes away.
+struct RuntimeScope {
+  std::optional<PropNames> names;
+  // Host functions by property name.
+  std::unordered_map<std::string, jsi::Function> functions;
+  bool released{false};
+};
+
+namespace {
+
+// Native frame loop requested by startEngine; JS then only reads frames.
+struct FrameLoopOptions {
+  double rateHz{0.0};
+  bool onPose{false};
+
+  bool enabled() const {
+    return rateHz > 0.0 || onPose;
+  }
+};
+
+FrameLoopOptions readFrameLoopOptions(jsi::Runtime& rt, const PropNames& names, const jsi::Object& object) {
+  FrameLoopOptions options{};
+  if (object.hasProperty(rt, names.frameRateHz)) {
+    options.rateHz = object.getProperty(rt, names.frameRateHz).asNumber();
+  }
+  if (object.hasProperty(rt, names.frameOnPose)) {
+    options.onPose = object.getProperty(rt, names.frameOnPose).getBool();
+  }
+  return options;
+}
+
+FrameFormat readFrameFormat(jsi::Runtime& rt, const jsi::Value& value) {
+  const std::string format = value.asString(rt).utf8(rt);
+  if (format == "float32") {
+    return FrameFormat::Float32;
+  }
+  if (format == "fixed16") {
+    return FrameFormat::Fixed16;
+  }
+  if (format == "half") {
+    return FrameFormat::Half;
+  }
+  if (format == "vertex") {
+    return FrameFormat::Vertex;
+  }
+  throw jsi::JSError(rt, "AstroCore: unknown frameFormat '" + format + "'.");
+}
+
+PointStyle readPointStyle(jsi::Runtime& rt, const PropNames& names, const jsi::Object& object) {
+  PointStyle style{};
+  auto read = [&](const jsi::PropNameID& name, double& field) {
+    if (object.hasProperty(rt, name)) {
+      field = object.getProperty(rt, name).asNumber();
+    }
+  };
+  read(names.sizeAtMag0, style.sizeAtMag0);
+  read(names.sizePerMag, style.sizePerMag);
+  read(names.minSize, style.minSize);
+  read(names.maxSize, style.maxSize);
+  read(names.alphaAtMag0, style.alphaAtMag0);
+  read(names.alphaPerMag, style.alphaPerMag);
+  read(names.minAlpha, style.minAlpha);
+  return style;
+}
+
+EngineConfig readEngineConfig(jsi::Runtime& rt, const PropNames& names, const jsi::Object& object) {
   EngineConfig config{};
 
-  if (object.hasProperty(rt, "fovDeg")) {
-    config.fovDeg = object.getProperty(rt, "fovDeg").asNumber();
+  if (object.hasProperty(rt, names.fovDeg)) {
+    config.fovDeg = object.getProperty(rt, names.fovDeg).asNumber();
+  }
+  if (object.hasProperty(rt, names.width)) {
+    config.screen.width = static_cast<int>(object.getProperty(rt, names.width).asNumber());
+  }
+  if (object.hasProperty(rt, names.height)) {
+    config.screen.height = static_cast<int>(object.getProperty(rt, names.height).asNumber());
+  }
+  if (object.hasProperty(rt, names.applyRefraction)) {
+    config.applyRefraction = object.getProperty(rt, names.applyRefraction).getBool();
+  }
+  if (object.hasProperty(rt, names.workerThreads)) {
+    config.workerThreads = static_cast<int>(object.getProperty(rt, names.workerThreads).asNumber());
+  }
+  if (object.hasProperty(rt, names.limitingMag)) {
+    config.limitingMag = object.getProperty(rt, names.limitingMag).asNumber();
+  }
+  if (object.hasProperty(rt, names.limitingMagFollowsFov)) {
+    config.limitingMagFollowsFov = object.getProperty(rt, names.limitingMagFollowsFov).getBool();
+  }
+  if (object.hasProperty(rt, names.siderealToleranceDeg)) {
+    config.siderealToleranceDeg = object.getProperty(rt, names.siderealToleranceDeg).asNumber();
   }
-  if (object.hasProperty(rt, "width")) {
-    config.screen.width = static_cast<int>(object.getProperty(rt, "width").asNumber());
+  if (object.hasProperty(rt, names.apparentPlaces)) {
+    config.apparentPlaces = object.getProperty(rt, names.apparentPlaces).getBool();
   }
-  if (object.hasProperty(rt, "height")) {
-    config.screen.height = static_cast<int>(object.getProperty(rt, "height").asNumber());
+  if (object.hasProperty(rt, names.apparentFrameIntervalDays)) {
+    config.apparentFrameIntervalDays = object.getProperty(rt, names.apparentFrameIntervalDays).asNumber();
   }
-  if (object.hasProperty(rt, "applyRefraction")) {
-    config.applyRefraction = object.getProperty(rt, "applyRefraction").getBool();
+  if (object.hasProperty(rt, names.recordFrameStats)) {
+    config.recordFrameStats = object.getProperty(rt, names.recordFrameStats).getBool();
+  }
+  if (object.hasProperty(rt, names.frameFormat)) {
+    config.frameFormat = readFrameFormat(rt, object.getProperty(rt, names.frameFormat));
+  }
+  if (object.hasProperty(rt, names.pointStyle)) {
+    config.pointStyle = readPointStyle(rt, names, object.getProperty(rt, names.pointStyle).asObject(rt));
+  }
+  if (object.hasProperty(rt, names.maxPoseLeadMs)) {
+    config.maxPoseLeadMs = object.getProperty(rt, names.maxPoseLeadMs).asNumber();
+  }
+  if (object.hasProperty(rt, names.displayLatencyMs)) {
+    config.displayLatencyMs = object.getProperty(rt, names.displayLatencyMs).asNumber();
   }
 
   return config;
 }
 
-Observer readObserver(jsi::Runtime& rt, const jsi::Object& object) {
+Observer readObserver(jsi::Runtime& rt, const PropNames& names, const jsi::Object& object) {
   Observer observer{};
-  observer.latDeg = object.getProperty(rt, "latDeg").asNumber();
-  observer.lonDeg = object.getProperty(rt, "lonDeg").asNumber();
-  if (object.hasProperty(rt, "elevationM")) {
-    observer.elevationM = object.getProperty(rt, "elevationM").asNumber();
+  observer.latDeg = object.getProperty(rt, names.latDeg).asNumber();
+  observer.lonDeg = object.getProperty(rt, names.lonDeg).asNumber();
+  if (object.hasProperty(rt, names.elevationM)) {
+    observer.elevationM = object.getProperty(rt, names.elevationM).asNumber();
+  }
+  if (object.hasProperty(rt, names.pressureHPa)) {
+    observer.pressureHPa = object.getProperty(rt, names.pressureHPa).asNumber();
+  }
+  if (object.hasProperty(rt, names.temperatureC)) {
+    observer.temperatureC = object.getProperty(rt, names.temperatureC).asNumber();
   }
   return observer;
 }
 
-PoseQuat readPose(jsi::Runtime& rt, const jsi::Object& object) {
+CatalogOptions readCatalogOptions(jsi::Runtime& rt, const PropNames& names, const jsi::Object& object) {
+  CatalogOptions options{};
+  if (object.hasProperty(rt, names.sortByMagnitude)) {
+    options.sortByMagnitude = object.getProperty(rt, names.sortByMagnitude).getBool();
+  }
+  return options;
+}
+
+PoseQuat readPose(jsi::Runtime& rt, const PropNames& names, const jsi::Object& object) {
   PoseQuat pose{};
-  pose.w = object.getProperty(rt, "w").asNumber();
-  pose.x = object.getProperty(rt, "x").asNumber();
-  pose.y = object.getProperty(rt, "y").asNumber();
-  pose.z = object.getProperty(rt, "z").asNumber();
+  pose.w = object.getProperty(rt, names.w).asNumber();
+  pose.x = object.getProperty(rt, names.x).asNumber();
+  pose.y = object.getProperty(rt, names.y).asNumber();
+  pose.z = object.getProperty(rt, names.z).asNumber();
   return pose;
 }
 
-std::vector<StarIn> readStarVector(jsi::Runtime& rt, const jsi::Value& value) {
-  if (!value.isObject()) {
-    throw jsi::JSError(rt, "AstroCore.setStars expects a Float32Array or StarIn[].");
-  }
-
-  jsi::Object object = value.getObject(rt);
-
-  if (object.isArray(rt)) {
-    const std::size_t length = static_cast<std::size_t>(object.getProperty(rt, "length").asNumber());
-    std::vector<StarIn> stars;
-    stars.reserve(length);
-    for (std::size_t i = 0; i < length; ++i) {
-      jsi::Value item = object.getPropertyAtIndex(rt, static_cast<uint32_t>(i));
-      if (!item.isObject()) {
-        continue;
-      }
-      jsi::Object starObj = item.getObject(rt);
-      StarIn star{};
-      star.raDeg = starObj.getProperty(rt, "raDeg").asNumber();
-      star.decDeg = starObj.getProperty(rt, "decDeg").asNumber();
-      star.mag = starObj.getProperty(rt, "mag").asNumber();
-      if (starObj.hasProperty(rt, "hip")) {
-        star.hip = static_cast<int>(starObj.getProperty(rt, "hip").asNumber());
-      }
-      stars.push_back(star);
-    }
-    return stars;
+template <typename T>
+constexpr const char* typedArrayName() {
+  static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>);
+  return std::is_same_v<T, float> ? "Float32Array" : "Float64Array";
+}
+
+// Matched on the constructor name, so an Int32Array or Uint32Array of the
+// same element size does not pass for a Float32Array.
+template <typename T>
+bool isTypedArray(jsi::Runtime& rt, const PropNames& names, const jsi::Object& object) {
+  if (!object.hasProperty(rt, names.buffer) || !object.hasProperty(rt, names.constructor)) {
+    return false;
+  }
+  const jsi::Value constructor = object.getProperty(rt, names.constructor);
+  if (!constructor.isObject()) {
+    return false;
+  }
+  const jsi::Value name = constructor.getObject(rt).getProperty(rt, names.constructorName);
+  return name.isString() && name.getString(rt).utf8(rt) == typedArrayName<T>();
+}
+
+bool isFloat32Array(jsi::Runtime& rt, const PropNames& names, const jsi::Object& object) {
+  return isTypedArray<float>(rt, names, object);
+}
+
+// A non-negative integral count or offset read from JS, or nullopt when it is
+// not one or exceeds `limit`.
+std::optional<std::size_t> readIndex(const jsi::Value& value, std::size_t limit) {
+  if (!value.isNumber()) {
+    return std::nullopt;
+  }
+  const double number = value.getNumber();
+  if (!std::isfinite(number) || number < 0.0 || number != std::floor(number) ||
+      number > static_cast<double>(limit)) {
+    return std::nullopt;
+  }
+  return static_cast<std::size_t>(number);
+}
+
+// Elements of a typed array viewed in place; valid until the runtime runs JS
+// again. Throws unless the view lies inside its buffer and is aligned for T.
+template <typename T>
+std::span<const T> readTypedArray(jsi::Runtime& rt,
+                                  const PropNames& names,
+                                  const jsi::Object& object,
+                                  const char* caller) {
+  jsi::ArrayBuffer arrayBuffer = object.getProperty(rt, names.buffer).getObject(rt).getArrayBuffer(rt);
+  const std::size_t bufferBytes = arrayBuffer.size(rt);
+  const auto byteOffset = readIndex(object.getProperty(rt, names.byteOffset), bufferBytes);
+  if (!byteOffset || *byteOffset % alignof(T) != 0) {
+    throw jsi::JSError(rt, std::string(caller) + ": typed array byteOffset is out of range or misaligned.");
+  }
+  const auto length = readIndex(object.getProperty(rt, names.length), (bufferBytes - *byteOffset) / sizeof(T));
+  if (!length) {
+    throw jsi::JSError(rt, std::string(caller) + ": typed array runs past the end of its buffer.");
   }
+  const auto* data = reinterpret_cast<const T*>(arrayBuffer.data(rt) + *byteOffset);
+  return {data, *length};
+}
+
+// Packed (raDeg, decDeg, mag, hip) records viewed in place.
+std::span<const float> readStarRecords(jsi::Runtime& rt,
+                                       const PropNames& names,
+                                       const jsi::Object& object,
+                                       const char* caller) {
+  const std::span<const float> records = readTypedArray<float>(rt, names, object, caller);
+  if (records.size() % kPackedStarFloats != 0) {
+    throw jsi::JSError(rt, std::string(caller) + ": star buffer length must be a multiple of 4.");
+  }
+  return records;
+}
+
+double julianDateFromMillis(double tUnixMs) {
+  return time::unixMillisToJulianDate(static_cast<std::int64_t>(tUnixMs));
+}
 
-  if (object.hasProperty(rt, "buffer") && object.hasProperty(rt, "BYTES_PER_ELEMENT")) {
-    const auto bytesPerElement = object.getProperty(rt, "BYTES_PER_ELEMENT").asNumber();
-    if (bytesPerElement != 4) {
-      throw jsi::JSError(rt, "AstroCore.setStars expects a Float32Array.");
+std::vector<StarIn> readStarArray(jsi::Runtime& rt, const PropNames& names, const jsi::Object& object) {
+  const jsi::Array array = object.getArray(rt);
+  const std::size_t length = array.size(rt);
+  std::vector<StarIn> stars;
+  stars.reserve(length);
+  for (std::size_t i = 0; i < length; ++i) {
+    jsi::Value item = array.getValueAtIndex(rt, i);
+    if (!item.isObject()) {
+      continue;
     }
-    const std::size_t length = static_cast<std::size_t>(object.getProperty(rt, "length").asNumber());
-    const std::size_t stride = 4;
-    if (length % stride != 0) {
-      throw jsi::JSError(rt, "Star buffer length must be a multiple of 4.");
+    jsi::Object starObj = item.getObject(rt);
+    StarIn star{};
+    star.raDeg = starObj.getProperty(rt, names.raDeg).asNumber();
+    star.decDeg = starObj.getProperty(rt, names.decDeg).asNumber();
+    star.mag = starObj.getProperty(rt, names.mag).asNumber();
+    if (starObj.hasProperty(rt, names.hip)) {
+      star.hip = static_cast<int>(starObj.getProperty(rt, names.hip).asNumber());
     }
-    jsi::Object bufferObj = object.getProperty(rt, "buffer").getObject(rt);
-    jsi::ArrayBuffer arrayBuffer = bufferObj.getArrayBuffer(rt);
-    auto* data = reinterpret_cast<float*>(arrayBuffer.data(rt));
-    const std::size_t elementCount = length / stride;
-    std::vector<StarIn> stars;
-    stars.reserve(elementCount);
-
-    for (std::size_t i = 0; i < elementCount; ++i) {
-      const std::size_t base = i * stride;
-      StarIn star{};
-      star.raDeg = data[base];
-      star.decDeg = data[base + 1];
-      star.mag = data[base + 2];
-      star.hip = static_cast<int>(data[base + 3]);
-      stars.push_back(star);
+    if (starObj.hasProperty(rt, names.bv)) {
+      star.bv = starObj.getProperty(rt, names.bv).asNumber();
     }
-    return stars;
+    stars.push_back(star);
+  }
+  return stars;
+}
+
+jsi::Object percentilesObject(jsi::Runtime& rt, const Percentiles& percentiles) {
+  jsi::Object object(rt);
+  object.setProperty(rt, "p50", percentiles.p50);
+  object.setProperty(rt, "p95", percentiles.p95);
+  object.setProperty(rt, "p99", percentiles.p99);
+  return object;
+}
+
+// Diagnostics only, so it is built from plain property names.
+jsi::Object frameStatsObject(jsi::Runtime& rt, const FrameStats& stats) {
+  jsi::Object stageMicros(rt);
+  jsi::Object lastStageMicros(rt);
+  for (std::size_t s = 0; s < kFrameStageCount; ++s) {
+    const char* name = frameStageName(static_cast<FrameStage>(s));
+    stageMicros.setProperty(rt, name, percentilesObject(rt, stats.stageMicros[s]));
+    lastStageMicros.setProperty(rt, name, static_cast<double>(stats.last.stageMicros[s]));
+  }
+  jsi::Object counters(rt);
+  jsi::Object lastCounters(rt);
+  for (std::size_t c = 0; c < kFrameCounterCount; ++c) {
+    const char* name = frameCounterName(static_cast<FrameCounter>(c));
+    counters.setProperty(rt, name, percentilesObject(rt, stats.counters[c]));
+    lastCounters.setProperty(rt, name, static_cast<double>(stats.last.counters[c]));
   }
 
-  throw jsi::JSError(rt, "Unsupported star payload supplied to AstroCore.setStars.");
+  jsi::Object object(rt);
+  object.setProperty(rt, "frames", static_cast<double>(stats.frames));
+  object.setProperty(rt, "window", static_cast<double>(stats.window));
+  object.setProperty(rt, "stageMicros", std::move(stageMicros));
+  object.setProperty(rt, "counters", std::move(counters));
+  object.setProperty(rt, "lastStageMicros", std::move(lastStageMicros));
+  object.setProperty(rt, "lastCounters", std::move(lastCounters));
+  return object;
 }
 
-class FrameBufferHostObject final : public jsi::HostObject {
+// One ring-buffer slot exposed to JS without copying. Holding the engine
+// keeps the slot storage alive for as long as JS holds the ArrayBuffer.
+class FrameSlotBuffer final : public jsi::MutableBuffer {
  public:
-  FrameBufferHostObject(std::shared_ptr<AstroEngine> engine,
-                        const float* data,
-                        std::size_t byteLength)
+  FrameSlotBuffer(std::shared_ptr<AstroEngine> engine, const void* data, std::size_t byteLength)
       : engine_(std::move(engine)),
-        data_(reinterpret_cast<const std::uint8_t*>(data)),
+        data_(static_cast<const std::uint8_t*>(data)),
         length_(byteLength) {}
 
-  std::size_t size(jsi::Runtime&) override {
+  std::size_t size() const override {
     return length_;
   }
 
-  uint8_t* data(jsi::Runtime&) override {
+  std::uint8_t* data() override {
     return const_cast<std::uint8_t*>(data_);
   }
 
@@ -141,152 +407,420 @@ class FrameBufferHostObject final : public jsi::HostObject {
 
 }  // namespace
 
-AstroCoreHostObject::AstroCoreHostObject(std::shared_ptr<AstroEngine> engine)
-    : engine_(std::move(engine)) {}
+// The JS thread's pin on the frame it fetched last. Each getFrameBuffer call
+// moves it to the latest frame, so a returned Float32Array stays intact until
+// the next call even while frames keep being published.
+struct FrameReader {
+  std::shared_ptr<AstroEngine> engine;
+  RingBuffer::Frame pinned;
 
-std::vector<jsi::PropNameID> AstroCoreHostObject::getPropertyNames(jsi::Runtime& runtime) {
-  std::vector<std::string> names = {
+  ~FrameReader() {
+    engine->ringBuffer().release(pinned.slot);
+  }
+
+  const RingBuffer::Frame& advance() {
+    RingBuffer& buffer = engine->ringBuffer();
+    // Pin the new frame before unpinning the old one: when no frame was
+    // published in between they are the same slot.
+    const RingBuffer::Frame frame = buffer.acquire();
+    buffer.release(pinned.slot);
+    pinned = frame;
+    return pinned;
+  }
+};
+
+AstroCoreHostObject::AstroCoreHostObject(jsi::Runtime& runtime, std::shared_ptr<AstroEngine> engine)
+    : engine_(std::move(engine)),
+      reader_(std::make_shared<FrameReader>(FrameReader{engine_, {}})),
+      scope_(std::make_shared<RuntimeScope>()) {
+  // Host objects are created and called on the JS thread.
+  trace::setThreadName("js");
+  scope_->names.emplace(runtime);
+  names_ = std::shared_ptr<const PropNames>(scope_, &*scope_->names);
+
+  add(runtime,
+      "updatePose",
+      1,
+      [engine = engine_, names = names_](
+          jsi::Runtime& rt, const jsi::Value&, const jsi::Value* args, std::size_t count) {
+        if (count < 1 || !args[0].isObject()) {
+          throw jsi::JSError(rt, "AstroCore.updatePose expects an object.");
+        }
+        engine->updatePose(readPose(rt, *names, args[0].getObject(rt)));
+        return jsi::Value::undefined();
+      });
+
+  // A timestamped sensor sample, as plain numbers.
+  add(runtime,
+      "pushPose",
+      5,
+      [engine = engine_](jsi::Runtime& rt, const jsi::Value&, const jsi::Value* args, std::size_t count) {
+        if (count < 5 || !args[0].isNumber() || !args[1].isNumber() || !args[2].isNumber() || !args[3].isNumber() ||
+            !args[4].isNumber()) {
+          throw jsi::JSError(rt, "AstroCore.pushPose expects (tUnixMs, w, x, y, z).");
+        }
+        const PoseQuat pose{args[1].getNumber(), args[2].getNumber(), args[3].getNumber(), args[4].getNumber()};
+        engine->pushPose(args[0].getNumber(), pose);
+        return jsi::Value::undefined();
+      });
+
+  add(runtime,
+      "computeFrame",
+      1,
+      [engine = engine_](jsi::Runtime& rt, const jsi::Value&, const jsi::Value* args, std::size_t count) {
+        if (count < 1 || !args[0].isNumber()) {
+          throw jsi::JSError(rt, "AstroCore.computeFrame expects a timestamp in milliseconds.");
+        }
+        const double jd = julianDateFromMillis(args[0].asNumber());
+        // An optional display time predicts the pose from the pushPose history.
+        auto visible = count >= 2 && args[1].isNumber() ? engine->computeFrame(jd, args[1].getNumber())
+                                                        : engine->computeFrame(jd);
+        return jsi::Value(static_cast<double>(visible));
+      });
+
+  // updatePose + computeFrame in one crossing, with the pose as plain numbers.
+  add(runtime,
+      "computeFrameWithPose",
+      5,
+      [engine = engine_](jsi::Runtime& rt, const jsi::Value&, const jsi::Value* args, std::size_t count) {
+        if (count < 5 || !args[0].isNumber() || !args[1].isNumber() || !args[2].isNumber() ||
+            !args[3].isNumber() || !args[4].isNumber()) {
+          throw jsi::JSError(rt, "AstroCore.computeFrameWithPose expects (tUnixMs, w, x, y, z).");
+        }
+        const PoseQuat pose{args[1].getNumber(), args[2].getNumber(), args[3].getNumber(), args[4].getNumber()};
+        auto visible = engine->computeFrame(julianDateFromMillis(args[0].getNumber()), pose);
+        return jsi::Value(static_cast<double>(visible));
+      });
+
+  // Every one of `count` (tUnixMs, w, x, y, z) samples in a reused
+  // Float64Array goes into the pose history; the frame uses the newest.
+  add(runtime,
+      "computeFrameWithPoseBatch",
+      2,
+      [engine = engine_, names = names_](
+          jsi::Runtime& rt, const jsi::Value&, const jsi::Value* args, std::size_t count) {
+        if (count < 2 || !args[0].isObject() || !args[1].isNumber()) {
+          throw jsi::JSError(rt, "AstroCore.computeFrameWithPoseBatch expects a Float64Array and a sample count.");
+        }
+        const jsi::Object batch = args[0].getObject(rt);
+        if (!isTypedArray<double>(rt, *names, batch)) {
+          throw jsi::JSError(rt, "AstroCore.computeFrameWithPoseBatch expects a Float64Array.");
+        }
+        const std::span<const double> samples =
+            readTypedArray<double>(rt, *names, batch, "AstroCore.computeFrameWithPoseBatch");
+        const auto sampleCount = readIndex(args[1], samples.size() / kPoseSampleDoubles);
+        if (!sampleCount || *sampleCount == 0) {
+          throw jsi::JSError(rt, "AstroCore.computeFrameWithPoseBatch sample count is out of range.");
+        }
+        auto visible = engine->computeFrame(samples.first(*sampleCount * kPoseSampleDoubles));
+        return jsi::Value(static_cast<double>(visible));
+      });
+
+  add(runtime,
+      "acquireFrame",
+      0,
+      [reader = reader_](jsi::Runtime&, const jsi::Value&, const jsi::Value*, std::size_t) {
+        const RingBuffer::Frame& frame = reader->advance();
+        return jsi::Value(frame.slot == RingBuffer::kNoSlot ? -1.0 : static_cast<double>(frame.slot));
+      });
+
+  add(runtime,
       "startEngine",
+      1,
+      [engine = engine_, names = names_](
+          jsi::Runtime& rt, const jsi::Value&, const jsi::Value* args, std::size_t count) {
+        if (count < 1 || !args[0].isObject()) {
+          throw jsi::JSError(rt, "AstroCore.startEngine expects a config object.");
+        }
+        const jsi::Object object = args[0].getObject(rt);
+        engine->setConfig(readEngineConfig(rt, *names, object));
+        const FrameLoopOptions loop = readFrameLoopOptions(rt, *names, object);
+        if (loop.enabled()) {
+          const FrameClockFactory& factory = frameClockFactory();
+          engine->startFrameLoop(
+              factory ? factory(loop.rateHz) : std::make_shared<SteadyFrameClock>(loop.rateHz), loop.onPose);
+        } else {
+          engine->stopFrameLoop();
+        }
+        return jsi::Value(true);
+      });
+
+  add(runtime,
       "stopEngine",
+      0,
+      [engine = engine_](jsi::Runtime&, const jsi::Value&, const jsi::Value*, std::size_t) {
+        engine->stopFrameLoop();
+        engine->clearFrame();
+        return jsi::Value::undefined();
+      });
+
+  add(runtime,
       "setStars",
+      1,
+      [engine = engine_, names = names_](
+          jsi::Runtime& rt, const jsi::Value&, const jsi::Value* args, std::size_t count) {
+        if (count < 1) {
+          throw jsi::JSError(rt, "AstroCore.setStars expects an argument.");
+        }
+        if (!args[0].isObject()) {
+          throw jsi::JSError(rt, "AstroCore.setStars expects a Float32Array or StarIn[].");
+        }
+        CatalogOptions options{};
+        if (count > 1 && args[1].isObject()) {
+          options = readCatalogOptions(rt, *names, args[1].getObject(rt));
+        }
+        const jsi::Object payload = args[0].getObject(rt);
+        if (isFloat32Array(rt, *names, payload)) {
+          engine->setPackedStars(readStarRecords(rt, *names, payload, "AstroCore.setStars"), options);
+        } else if (payload.isArray(rt)) {
+          const auto stars = readStarArray(rt, *names, payload);
+          engine->setStars(std::span<const StarIn>(stars.data(), stars.size()), options);
+        } else {
+          throw jsi::JSError(rt, "Unsupported star payload supplied to AstroCore.setStars.");
+        }
+        return jsi::Value(true);
+      });
+
+  add(runtime,
+      "setStarsRange",
+      2,
+      [engine = engine_, names = names_](
+          jsi::Runtime& rt, const jsi::Value&, const jsi::Value* args, std::size_t count) {
+        if (count < 2 || !args[0].isNumber() || !args[1].isObject()) {
+          throw jsi::JSError(rt, "AstroCore.setStarsRange expects an offset and a Float32Array or StarIn[].");
+        }
+        const auto offset = readIndex(args[0], engine->starCount());
+        if (!offset) {
+          throw jsi::JSError(rt, "AstroCore.setStarsRange offset must be an integer within the catalog.");
+        }
+        const std::size_t first = *offset;
+        const jsi::Object payload = args[1].getObject(rt);
+        bool updated = false;
+        if (isFloat32Array(rt, *names, payload)) {
+          updated = engine->updatePackedStars(first, readStarRecords(rt, *names, payload, "AstroCore.setStarsRange"));
+        } else if (payload.isArray(rt)) {
+          const auto stars = readStarArray(rt, *names, payload);
+          updated = engine->updateStars(first, std::span<const StarIn>(stars.data(), stars.size()));
+        } else {
+          throw jsi::JSError(rt, "Unsupported star payload supplied to AstroCore.setStarsRange.");
+        }
+        if (!updated) {
+          throw jsi::JSError(rt, "AstroCore.setStarsRange range runs past the end of the catalog.");
+        }
+        return jsi::Value::undefined();
+      });
+
+  add(runtime,
+      "setStarColors",
+      2,
+      [engine = engine_, names = names_](
+          jsi::Runtime& rt, const jsi::Value&, const jsi::Value* args, std::size_t count) {
+        if (count < 2 || !args[0].isNumber() || !args[1].isObject() ||
+            !isFloat32Array(rt, *names, args[1].getObject(rt))) {
+          throw jsi::JSError(rt, "AstroCore.setStarColors expects an offset and a Float32Array.");
+        }
+        const auto offset = readIndex(args[0], engine->starCount());
+        if (!offset) {
+          throw jsi::JSError(rt, "AstroCore.setStarColors offset must be an integer within the catalog.");
+        }
+        const std::span<const float> bv =
+            readTypedArray<float>(rt, *names, args[1].getObject(rt), "AstroCore.setStarColors");
+        if (!engine->setStarColors(*offset, bv)) {
+          throw jsi::JSError(rt, "AstroCore.setStarColors range runs past the end of the catalog.");
+        }
+        return jsi::Value::undefined();
+      });
+
+  add(runtime,
+      "loadCatalog",
+      1,
+      [engine = engine_](jsi::Runtime& rt, const jsi::Value&, const jsi::Value* args, std::size_t count) {
+        if (count < 1 || !args[0].isString()) {
+          throw jsi::JSError(rt, "AstroCore.loadCatalog expects a file path.");
+        }
+        const std::string path = args[0].getString(rt).utf8(rt);
+        const CatalogFileStatus status = engine->loadCatalog(path);
+        if (status != CatalogFileStatus::Ok) {
+          throw jsi::JSError(rt, "AstroCore.loadCatalog: " + std::string(describe(status)) + ": " + path);
+        }
+        return jsi::Value(true);
+      });
+
+  add(runtime,
+      "setLimitingMag",
+      1,
+      [engine = engine_](jsi::Runtime& rt, const jsi::Value&, const jsi::Value* args, std::size_t count) {
+        if (count < 1 || !args[0].isNumber()) {
+          throw jsi::JSError(rt, "AstroCore.setLimitingMag expects a magnitude.");
+        }
+        engine->setLimitingMag(args[0].asNumber());
+        return jsi::Value::undefined();
+      });
+
+  add(runtime,
       "setObserver",
+      1,
+      [engine = engine_, names = names_](
+          jsi::Runtime& rt, const jsi::Value&, const jsi::Value* args, std::size_t count) {
+        if (count < 1 || !args[0].isObject()) {
+          throw jsi::JSError(rt, "AstroCore.setObserver expects an object.");
+        }
+        engine->setObserver(readObserver(rt, *names, args[0].getObject(rt)));
+        return jsi::Value::undefined();
+      });
+
+  add(runtime,
       "setConfig",
-      "updatePose",
-      "computeFrame",
-      "getFrameBuffer"};
+      1,
+      [engine = engine_, names = names_](
+          jsi::Runtime& rt, const jsi::Value&, const jsi::Value* args, std::size_t count) {
+        if (count < 1 || !args[0].isObject()) {
+          throw jsi::JSError(rt, "AstroCore.setConfig expects a config object.");
+        }
+        engine->setConfig(readEngineConfig(rt, *names, args[0].getObject(rt)));
+        return jsi::Value::undefined();
+      });
+
+  add(runtime,
+      "getFrameStats",
+      0,
+      [engine = engine_](jsi::Runtime& rt, const jsi::Value&, const jsi::Value*, std::size_t) {
+        return frameStatsObject(rt, engine->frameStats());
+      });
+
+  add(runtime,
+      "resetFrameStats",
+      0,
+      [engine = engine_](jsi::Runtime&, const jsi::Value&, const jsi::Value*, std::size_t) {
+        engine->resetFrameStats();
+        return jsi::Value::undefined();
+      });
+
+  add(runtime,
+      "startTrace",
+      0,
+      [](jsi::Runtime&, const jsi::Value&, const jsi::Value*, std::size_t) {
+        trace::start();
+        return jsi::Value::undefined();
+      });
+
+  add(runtime,
+      "stopTrace",
+      0,
+      [](jsi::Runtime&, const jsi::Value&, const jsi::Value*, std::size_t) {
+        trace::stop();
+        return jsi::Value::undefined();
+      });
+
+  add(runtime,
+      "dumpTrace",
+      1,
+      [](jsi::Runtime& rt, const jsi::Value&, const jsi::Value* args, std::size_t count) {
+        if (count < 1 || !args[0].isString()) {
+          throw jsi::JSError(rt, "AstroCore.dumpTrace expects a file path.");
+        }
+        return jsi::Value(trace::dump(args[0].getString(rt).utf8(rt)));
+      });
+
+  add(runtime,
+      "getFrameSlots",
+      0,
+      [engine = engine_](jsi::Runtime& rt, const jsi::Value&, const jsi::Value*, std::size_t) {
+        // Slot storage never moves, so JS builds its views over these once
+        // and picks one per frame with acquireFrame.
+        const RingBuffer& buffer = engine->ringBuffer();
+        jsi::Array slots(rt, buffer.slotCount());
+        for (std::uint32_t s = 0; s < buffer.slotCount(); ++s) {
+          slots.setValueAtIndex(
+              rt,
+              s,
+              jsi::ArrayBuffer(rt,
+                               std::make_shared<FrameSlotBuffer>(engine, buffer.slotBytes(s), buffer.byteLength())));
+        }
+        return slots;
+      });
+
+  // Deprecated: allocates a Float32Array over a fresh ArrayBuffer per call.
+  // SkyEngine.getFrameBuffer() reads the getFrameSlots() views instead; this
+  // stays for callers that hold the raw binding.
+  add(runtime,
+      "getFrameBuffer",
+      0,
+      [engine = engine_, reader = reader_](jsi::Runtime& rt, const jsi::Value&, const jsi::Value*, std::size_t) {
+        const RingBuffer& buffer = engine->ringBuffer();
+        const RingBuffer::Frame& frame = reader->advance();
+        if (frame.data != nullptr &&
+            buffer.header(frame.slot).format != static_cast<double>(FrameFormat::Float32)) {
+          throw jsi::JSError(rt, "AstroCore.getFrameBuffer only serves the float32 frame format; use getFrame().");
+        }
+
+        const std::size_t byteLen = frame.count * buffer.stride() * sizeof(float);
+        const float* data = frame.data != nullptr ? frame.data : buffer.slotData(0);
+        jsi::ArrayBuffer arrayBuffer(rt, std::make_shared<FrameSlotBuffer>(engine, data, byteLen));
+        jsi::Function float32ArrayCtor =
+            rt.global().getPropertyAsFunction(rt, "Float32Array");
+        return float32ArrayCtor.callAsConstructor(rt, arrayBuffer);
+      });
+}
 
+AstroCoreHostObject::~AstroCoreHostObject() = default;
+
+void AstroCoreHostObject::release() {
+  scope_->released = true;
+  scope_->functions.clear();
+  names_.reset();
+  scope_->names.reset();
+}
+
+void AstroCoreHostObject::add(jsi::Runtime& runtime,
+                              const char* name,
+                              unsigned int paramCount,
+                              jsi::HostFunctionType function) {
+  // The scope is not owned by its own functions; a released one refuses the
+  // call, since the names the function reads are gone.
+  function = [name, scope = std::weak_ptr<const RuntimeScope>(scope_), inner = std::move(function)](
+                 jsi::Runtime& rt, const jsi::Value& thisValue, const jsi::Value* args, std::size_t count) {
+    const std::shared_ptr<const RuntimeScope> live = scope.lock();
+    if (!live || live->released) {
+      throw jsi::JSError(rt, std::string("AstroCore.") + name + " was called after the bindings were released.");
+    }
+    if constexpr (trace::kCompiled) {
+      // The span keeps the pointer to the literal `name`.
+      trace::Span span("jsi", name);
+      return inner(rt, thisValue, args, count);
+    } else {
+      return inner(rt, thisValue, args, count);
+    }
+  };
+  const jsi::PropNameID id = jsi::PropNameID::forAscii(runtime, name);
+  scope_->functions.emplace(name,
+                            jsi::Function::createFromHostFunction(runtime, id, paramCount, std::move(function)));
+}
+
+std::vector<jsi::PropNameID> AstroCoreHostObject::getPropertyNames(jsi::Runtime& runtime) {
   std::vector<jsi::PropNameID> props;
-  props.reserve(names.size());
-  for (const auto& name : names) {
-    props.push_back(jsi::PropNameID::forAscii(runtime, name));
+  props.reserve(scope_->functions.size());
+  for (const auto& entry : scope_->functions) {
+    props.push_back(jsi::PropNameID::forUtf8(runtime, entry.first));
   }
   return props;
 }
 
 jsi::Value AstroCoreHostObject::get(jsi::Runtime& runtime, const jsi::PropNameID& name) {
-  const auto propName = name.utf8(runtime);
-
-  if (propName == "startEngine") {
-    return jsi::Function::createFromHostFunction(
-        runtime,
-        name,
-        1,
-        [engine = engine_](jsi::Runtime& rt, const jsi::Value&, const jsi::Value* args, std::size_t count) {
-          if (count < 1 || !args[0].isObject()) {
-            throw jsi::JSError(rt, "AstroCore.startEngine expects a config object.");
-          }
-          const EngineConfig config = readEngineConfig(rt, args[0].getObject(rt));
-          engine->setConfig(config);
-          return jsi::Value(true);
-        });
-  }
-
-  if (propName == "stopEngine") {
-    return jsi::Function::createFromHostFunction(
-        runtime,
-        name,
-        0,
-        [engine = engine_](jsi::Runtime&, const jsi::Value&, const jsi::Value*, std::size_t) {
-          engine->ringBuffer().commit(0);
-          return jsi::Value::undefined();
-        });
-  }
-
-  if (propName == "setStars") {
-    return jsi::Function::createFromHostFunction(
-        runtime,
-        name,
-        1,
-        [engine = engine_](jsi::Runtime& rt, const jsi::Value&, const jsi::Value* args, std::size_t count) {
-          if (count < 1) {
-            throw jsi::JSError(rt, "AstroCore.setStars expects an argument.");
-          }
-          auto stars = readStarVector(rt, args[0]);
-          engine->setStars(std::span<const StarIn>(stars.data(), stars.size()));
-          return jsi::Value(true);
-        });
-  }
-
-  if (propName == "setObserver") {
-    return jsi::Function::createFromHostFunction(
-        runtime,
-        name,
-        1,
-        [engine = engine_](jsi::Runtime& rt, const jsi::Value&, const jsi::Value* args, std::size_t count) {
-          if (count < 1 || !args[0].isObject()) {
-            throw jsi::JSError(rt, "AstroCore.setObserver expects an object.");
-          }
-          engine->setObserver(readObserver(rt, args[0].getObject(rt)));
-          return jsi::Value::undefined();
-        });
-  }
-
-  if (propName == "setConfig") {
-    return jsi::Function::createFromHostFunction(
-        runtime,
-        name,
-        1,
-        [engine = engine_](jsi::Runtime& rt, const jsi::Value&, const jsi::Value* args, std::size_t count) {
-          if (count < 1 || !args[0].isObject()) {
-            throw jsi::JSError(rt, "AstroCore.setConfig expects a config object.");
-          }
-          engine->setConfig(readEngineConfig(rt, args[0].getObject(rt)));
-          return jsi::Value::undefined();
-        });
-  }
-
-  if (propName == "updatePose") {
-    return jsi::Function::createFromHostFunction(
-        runtime,
-        name,
-        1,
-        [engine = engine_](jsi::Runtime& rt, const jsi::Value&, const jsi::Value* args, std::size_t count) {
-          if (count < 1 || !args[0].isObject()) {
-            throw jsi::JSError(rt, "AstroCore.updatePose expects an object.");
-          }
-          engine->updatePose(readPose(rt, args[0].getObject(rt)));
-          return jsi::Value::undefined();
-        });
-  }
-
-  if (propName == "computeFrame") {
-    return jsi::Function::createFromHostFunction(
-        runtime,
-        name,
-        1,
-        [engine = engine_](jsi::Runtime& rt, const jsi::Value&, const jsi::Value* args, std::size_t count) {
-          if (count < 1 || !args[0].isNumber()) {
-            throw jsi::JSError(rt, "AstroCore.computeFrame expects a timestamp in milliseconds.");
-          }
-          const double jd = time::unixMillisToJulianDate(static_cast<std::int64_t>(args[0].asNumber()));
-          auto visible = engine->computeFrame(jd);
-          return jsi::Value(static_cast<double>(visible));
-        });
-  }
-
-  if (propName == "getFrameBuffer") {
-    return jsi::Function::createFromHostFunction(
-        runtime,
-        name,
-        0,
-        [engine = engine_](jsi::Runtime& rt, const jsi::Value&, const jsi::Value*, std::size_t) {
-          const RingBuffer& buffer = engine->ringBuffer();
-          const std::size_t byteLen = buffer.count() * buffer.stride() * sizeof(float);
-          const float* data = buffer.readPtr();
-          auto hostObject = std::make_shared<FrameBufferHostObject>(engine, data, byteLen);
-          auto arrayBuffer = jsi::ArrayBuffer::createFromHostObject(rt, hostObject);
-          jsi::Function float32ArrayCtor =
-              rt.global().getPropertyAsFunction(rt, "Float32Array");
-          return float32ArrayCtor.callAsConstructor(rt, arrayBuffer);
-        });
-  }
-
-  return jsi::Value::undefined();
+  const auto entry = scope_->functions.find(name.utf8(runtime));
+  if (entry == scope_->functions.end()) {
+    return jsi::Value::undefined();
+  }
+  return jsi::Value(runtime, entry->second);
+}
+
+void setFrameClockFactory(FrameClockFactory factory) {
+  frameClockFactory() = std::move(factory);
 }
 
 jsi::Object createAstroCoreBinding(jsi::Runtime& runtime) {
   auto engine = std::make_shared<AstroEngine>();
-  auto hostObject = std::make_shared<AstroCoreHostObject>(engine);
+  auto hostObject = std::make_shared<AstroCoreHostObject>(runtime, engine);
   return jsi::Object::createFromHostObject(runtime, hostObject);
 }
 
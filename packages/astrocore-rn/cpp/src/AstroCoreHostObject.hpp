@@ -9,15 +9,41 @@
 
 namespace astro::jsi {
 
+struct FrameReader;
+struct PropNames;
+struct RuntimeScope;
+
+// Host functions are created once per runtime and looked up by name in a
+// hash table, so calling into the engine from JS allocates no closures.
+//
+// The runtime may destroy the host object after it has torn itself down, so
+// every cached JSI value lives in a RuntimeScope that release() empties while
+// the runtime is still alive.
 class AstroCoreHostObject final : public facebook::jsi::HostObject {
  public:
-  explicit AstroCoreHostObject(std::shared_ptr<AstroEngine> engine);
+  AstroCoreHostObject(facebook::jsi::Runtime& runtime, std::shared_ptr<AstroEngine> engine);
+  ~AstroCoreHostObject() override;
 
   std::vector<facebook::jsi::PropNameID> getPropertyNames(facebook::jsi::Runtime& runtime) override;
   facebook::jsi::Value get(facebook::jsi::Runtime& runtime, const facebook::jsi::PropNameID& name) override;
 
+  // Drops the cached functions and property names. Call on the JS thread
+  // before the runtime is destroyed; host functions JS still holds throw
+  // afterwards.
+  void release();
+
  private:
+  // `name` must be a string literal; it also labels the call in traces.
+  void add(facebook::jsi::Runtime& runtime,
+           const char* name,
+           unsigned int paramCount,
+           facebook::jsi::HostFunctionType function);
+
   std::shared_ptr<AstroEngine> engine_;
+  std::shared_ptr<FrameReader> reader_;
+  std::shared_ptr<RuntimeScope> scope_;
+  // Points into scope_; empty after release().
+  std::shared_ptr<const PropNames> names_;
 };
 
 facebook::jsi::Object createAstroCoreBinding(facebook::jsi::Runtime& runtime);
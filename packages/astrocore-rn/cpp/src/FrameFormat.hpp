@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "RingBuffer.hpp"
+#include "astro/types.hpp"
+
+namespace astro {
+
+// Fixed16 quantization (see FrameFormat).
+inline constexpr float kFixedSubpixels = 8.0f;
+inline constexpr float kFixedMagOffset = -2.0f;
+inline constexpr float kFixedMagSteps = 16.0f;
+
+// Widest record of any format (Vertex plus its id), which the engine sizes
+// the ring-buffer slots for.
+inline constexpr std::size_t kMaxFrameRecordBytes = 20;
+
+// Ring-buffer columns of a format. The header's format field is the
+// FrameFormat value.
+RingBuffer::Layout frameLayout(FrameFormat format);
+
+// Converts `count` (x, y, mag, hip) float records, written with
+// ProjectionParams::rawIds, into the columns of a compact format.
+void encodeFrame(FrameFormat format,
+                 const float* records,
+                 std::size_t count,
+                 const std::array<std::uint8_t*, RingBuffer::kMaxColumns>& columns);
+
+// Converts `count` (x, y, mag, slot) float records, written with
+// ProjectionParams::rawIds over catalog slot numbers, into Vertex columns.
+// `hip` and `bv` are the catalog's columns; a null `bv` draws every star white.
+void encodeVertices(const float* records,
+                    std::size_t count,
+                    const std::int32_t* hip,
+                    const float* bv,
+                    const PointStyle& style,
+                    const std::array<std::uint8_t*, RingBuffer::kMaxColumns>& columns);
+
+// Packed color of a star with color index `bv` (NaN for white) at opacity
+// `alpha` in [0, 1]: bytes R, G, B, A in memory order. The B-V range
+// [-0.4, 2.0] is sampled in 256 steps.
+std::uint32_t starColor(float bv, float alpha);
+
+// IEEE 754 binary16, rounding to nearest even.
+std::uint16_t floatToHalf(float value);
+float halfToFloat(std::uint16_t half);
+
+}  // namespace astro
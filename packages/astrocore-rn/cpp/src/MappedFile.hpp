@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace astro {
+
+// Read-only mapping of a whole file. Pages are faulted in from the page
+// cache on first touch and shared with every other mapping of the file.
+class MappedFile {
+ public:
+  // Null when the file cannot be opened or mapped.
+  static std::shared_ptr<const MappedFile> open(const std::string& path);
+
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const std::byte* data() const noexcept {
+    return data_;
+  }
+  std::size_t size() const noexcept {
+    return size_;
+  }
+
+ private:
+  MappedFile(const std::byte* data, std::size_t size) : data_(data), size_(size) {}
+
+  const std::byte* data_;
+  std::size_t size_;
+};
+
+}  // namespace astro
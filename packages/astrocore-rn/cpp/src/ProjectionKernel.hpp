@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "astro/FrameStats.hpp"
+#include "astro/transform.hpp"
+
+namespace astro {
+
+// Stars a kernel rejected, by the first test they failed.
+struct CullCounters {
+  std::size_t faint{0};
+  std::size_t belowHorizon{0};
+  std::size_t behindCamera{0};
+  std::size_t offScreen{0};
+};
+
+// Per-frame constants shared by every projection kernel, in single precision.
+struct ProjectionParams {
+  float toDevice[3][3];
+  float zenith[3];
+  float deviceUp[3];
+  float halfWidth;
+  float halfHeight;
+  float focalLength;
+  float width;
+  float height;
+  // Per-star magnitude cut, only needed when the catalog ranges were not
+  // already trimmed at the limit.
+  float limitingMag;
+  bool filterMagnitude;
+  // Null when refraction is off.
+  const transform::RefractionTable* refraction;
+  // Store the hip column's int32 bit pattern instead of its value converted
+  // to float, so formats with integer ids get them back exactly.
+  bool rawIds;
+  // Accumulates rejections when set; ignored when frame stats are compiled
+  // out.
+  CullCounters* counters;
+};
+
+// Read-only view of the catalog columns a kernel streams through.
+struct CatalogColumns {
+  const float* x;
+  const float* y;
+  const float* z;
+  const float* mag;
+  const std::int32_t* hip;
+};
+
+// Projects stars [begin, end) and appends the visible ones to `out` as
+// (x, y, mag, hip) records (hip per ProjectionParams::rawIds), writing at most `capacity` records. Returns the
+// number written. Every implementation produces bit-identical output.
+using ProjectionKernel = std::size_t (*)(const ProjectionParams& params,
+                                         const CatalogColumns& stars,
+                                         std::size_t begin,
+                                         std::size_t end,
+                                         float* out,
+                                         std::size_t capacity);
+
+struct ProjectionKernelInfo {
+  const char* name;
+  std::size_t lanes;
+  ProjectionKernel kernel;
+  bool (*supported)();
+};
+
+std::size_t projectStarsScalar(const ProjectionParams& params,
+                               const CatalogColumns& stars,
+                               std::size_t begin,
+                               std::size_t end,
+                               float* out,
+                               std::size_t capacity);
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ASTRO_HAVE_X86_KERNELS 1
+std::size_t projectStarsSse41(const ProjectionParams& params,
+                              const CatalogColumns& stars,
+                              std::size_t begin,
+                              std::size_t end,
+                              float* out,
+                              std::size_t capacity);
+std::size_t projectStarsAvx2(const ProjectionParams& params,
+                             const CatalogColumns& stars,
+                             std::size_t begin,
+                             std::size_t end,
+                             float* out,
+                             std::size_t capacity);
+std::size_t projectStarsAvx512(const ProjectionParams& params,
+                               const CatalogColumns& stars,
+                               std::size_t begin,
+                               std::size_t end,
+                               float* out,
+                               std::size_t capacity);
+#endif
+
+#if defined(__aarch64__)
+#define ASTRO_HAVE_NEON_KERNELS 1
+std::size_t projectStarsNeon(const ProjectionParams& params,
+                             const CatalogColumns& stars,
+                             std::size_t begin,
+                             std::size_t end,
+                             float* out,
+                             std::size_t capacity);
+#endif
+
+// Fastest kernel supported by the running CPU, resolved once.
+const ProjectionKernelInfo& selectProjectionKernel();
+
+// Scalar kernel first, followed by every SIMD kernel the running CPU supports.
+std::size_t availableProjectionKernels(const ProjectionKernelInfo** out, std::size_t maxCount);
+
+inline CullCounters* cullCounters(const ProjectionParams& params) {
+  return kFrameStatsCompiled ? params.counters : nullptr;
+}
+
+inline void addCulled(CullCounters& into, const CullCounters& from) {
+  into.faint += from.faint;
+  into.belowHorizon += from.belowHorizon;
+  into.behindCamera += from.behindCamera;
+  into.offScreen += from.offScreen;
+}
+
+// Refraction for a batch of lanes. Shared by every kernel so the scalar and
+// SIMD paths round identically.
+inline void refractLanes(const transform::RefractionTable& table,
+                         const float* up,
+                         float* scale,
+                         float* shiftedUp,
+                         std::size_t lanes) {
+  for (std::size_t lane = 0; lane < lanes; ++lane) {
+    table.lookup(up[lane], scale[lane], shiftedUp[lane]);
+  }
+}
+
+}  // namespace astro
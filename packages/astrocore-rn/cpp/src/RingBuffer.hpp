@@ -1,81 +1,311 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
 #include <span>
 #include <vector>
 
+#include "astro/AlignedAllocator.hpp"
+
 namespace astro {
 
+// Lock-free single-producer/single-consumer frame exchange over a fixed set of
+// slots. The producer fills a slot of its own and publishes it with commit();
+// the consumer pins the latest published slot with acquire(), and the
+// producer never reuses a pinned slot until it is released. Slot storage is
+// allocated once by configure(), so pointers into it stay valid for the
+// lifetime of the buffer.
+//
+// With the default four slots the producer always has somewhere to write
+// while the consumer holds one pin and is handing over to the next.
+//
+// Each slot starts with a FrameHeader written by commit(), followed by the
+// records, so a reader holding just the slot's memory (e.g. a JS view over
+// it) can tell which frame it is looking at.
+//
+// Records are stored in up to kMaxColumns columns (see Layout). The slots are
+// allocated once for `stride` floats per record, or more when configure() is
+// given a wider record, and any layout that fits in that space can be
+// switched to between frames without moving them.
 class RingBuffer {
  public:
-  void configure(std::size_t stride, std::size_t capacity);
+  static constexpr std::size_t kDefaultSlots = 4;
+  static constexpr std::uint32_t kNoSlot = UINT32_MAX;
+  static constexpr std::size_t kMaxColumns = 3;
+
+  // Columns of columnBytes[c] bytes per record, stored one after another,
+  // each starting on a cache line; unused columns are 0 bytes wide. `format`
+  // is handed through to readers in the header.
+  struct Layout {
+    std::uint32_t format{0};
+    std::array<std::size_t, kMaxColumns> columnBytes{};
+  };
+
+  // Doubles so JS can read every field exactly through one Float64Array.
+  struct FrameHeader {
+    double sequence;
+    double julianDate;
+    double count;
+    double slot;
+    double format;
+    double capacity;
+    // Byte offsets of columns 1 and 2 from the start of the slot, 0 when
+    // unused. Column 0 follows the header.
+    double columnOffset[2];
+  };
+  static_assert(sizeof(FrameHeader) == kCacheLineSize, "records stay cache-line aligned");
+  static constexpr std::size_t kHeaderFloats = sizeof(FrameHeader) / sizeof(float);
+
+  struct Frame {
+    std::uint32_t slot{kNoSlot};
+    std::uint64_t sequence{0};
+    const float* data{nullptr};
+    std::size_t count{0};
+  };
+
+  // Not thread-safe: call before frames start flowing. Starts out with a
+  // single column of `stride` floats per record. A `recordBytes` above that
+  // sizes the slots for the widest layout to be used, including the padding
+  // that starts each column on a cache line.
+  void configure(std::size_t stride,
+                 std::size_t capacity,
+                 std::size_t slots = kDefaultSlots,
+                 std::size_t recordBytes = 0);
+  // Producer side, between frames. Returns false, keeping the current
+  // layout, when `layout` does not fit the slots.
+  bool setLayout(const Layout& layout);
+  const Layout& layout() const;
 
+  // Producer side. writePtr() returns null when every other slot is pinned;
+  // commit() stamps the header and publishes the slot it returned, or drops
+  // the frame if there was none.
   float* writePtr();
-  void commit(std::size_t count);
+  // Start of a column in the slot writePtr() returned.
+  std::uint8_t* writeColumn(std::size_t column);
+  void commit(std::size_t count, double julianDate = 0.0);
 
+  // Consumer side. acquire() pins the latest published frame (slot kNoSlot
+  // before the first commit); each pin must be released exactly once.
+  Frame acquire();
+  void release(std::uint32_t slot);
+
+  // Latest published frame, unpinned. Only safe while the producer runs on
+  // the calling thread. Spans cover column 0.
   const float* readPtr() const;
   std::span<const float> readSpan() const;
-  std::size_t stride() const;
   std::size_t count() const;
+  std::uint64_t sequence() const;
+
+  std::size_t stride() const;
+  std::size_t capacity() const;
+  std::size_t slotCount() const;
+  // Records (column 0) of a slot, just past its header.
+  const float* slotData(std::uint32_t slot) const;
+  // Byte offset of a column from the start of a slot.
+  std::size_t columnOffset(std::size_t column) const;
+  // A whole slot, header included, and its size in bytes.
+  const std::uint8_t* slotBytes(std::uint32_t slot) const;
   std::size_t byteLength() const;
+  // Header of a slot; only meaningful while the slot is pinned.
+  FrameHeader header(std::uint32_t slot) const;
 
  private:
-  void ensureSize(std::vector<float>& buffer, std::size_t stride, std::size_t capacity);
+  // Each slot on its own cache line so the consumer's pin traffic does not
+  // contend with the producer's publishes.
+  struct alignas(kCacheLineSize) Slot {
+    std::vector<float, AlignedAllocator<float>> data;
+    std::atomic<std::uint64_t> sequence{0};
+    std::atomic<std::size_t> count{0};
+    std::atomic<std::uint32_t> pins{0};
+  };
 
-  std::vector<float> front_;
-  std::vector<float> back_;
+  std::unique_ptr<Slot[]> slots_;
+  std::size_t slotCount_{0};
   std::size_t stride_{0};
   std::size_t capacity_{0};
-  std::size_t count_{0};
+  std::size_t slotFloats_{0};
+  Layout layout_;
+  std::array<std::size_t, kMaxColumns> columnOffsets_{};
+  std::atomic<std::uint32_t> latest_{kNoSlot};
+  // Producer-only state.
+  std::uint32_t writeSlot_{kNoSlot};
+  std::uint64_t nextSequence_{0};
 };
 
 }  // namespace astro
 
 namespace astro {
 
-inline void RingBuffer::configure(std::size_t stride, std::size_t capacity) {
+inline void RingBuffer::configure(std::size_t stride,
+                                  std::size_t capacity,
+                                  std::size_t slots,
+                                  std::size_t recordBytes) {
+  slotCount_ = std::max<std::size_t>(slots, 3);
+  slotFloats_ = kHeaderFloats + stride * capacity;
+  if (recordBytes > stride * sizeof(float)) {
+    const std::size_t padding = (kMaxColumns - 1) * kCacheLineSize;
+    slotFloats_ = kHeaderFloats + (recordBytes * capacity + padding + sizeof(float) - 1) / sizeof(float);
+  }
+  slots_ = std::make_unique<Slot[]>(slotCount_);
+  for (std::size_t s = 0; s < slotCount_; ++s) {
+    slots_[s].data.assign(slotFloats_, 0.0f);
+  }
   stride_ = stride;
   capacity_ = capacity;
-  ensureSize(front_, stride, capacity);
-  ensureSize(back_, stride, capacity);
-  count_ = 0;
+  setLayout({0, {stride * sizeof(float), 0, 0}});
+  latest_.store(kNoSlot);
+  writeSlot_ = kNoSlot;
+  nextSequence_ = 0;
+}
+
+inline bool RingBuffer::setLayout(const Layout& layout) {
+  std::array<std::size_t, kMaxColumns> offsets{};
+  std::size_t end = sizeof(FrameHeader);
+  for (std::size_t c = 0; c < kMaxColumns; ++c) {
+    if (layout.columnBytes[c] == 0) {
+      continue;
+    }
+    offsets[c] = (end + kCacheLineSize - 1) / kCacheLineSize * kCacheLineSize;
+    end = offsets[c] + layout.columnBytes[c] * capacity_;
+  }
+  if (layout.columnBytes[0] == 0 || end > byteLength()) {
+    return false;
+  }
+  layout_ = layout;
+  columnOffsets_ = offsets;
+  return true;
 }
 
-inline void RingBuffer::ensureSize(std::vector<float>& buffer, std::size_t stride, std::size_t capacity) {
-  buffer.resize(stride * capacity);
+inline const RingBuffer::Layout& RingBuffer::layout() const {
+  return layout_;
 }
 
 inline float* RingBuffer::writePtr() {
-  return back_.data();
+  if (writeSlot_ == kNoSlot) {
+    // Pairs with the pin-then-recheck in acquire(): a slot is only taken if
+    // it is neither the latest frame nor pinned, and both are read with
+    // sequentially consistent ordering so a racing pin is always seen by one
+    // side or the other.
+    const std::uint32_t latest = latest_.load();
+    for (std::uint32_t s = 0; s < slotCount_; ++s) {
+      if (s != latest && slots_[s].pins.load() == 0) {
+        writeSlot_ = s;
+        break;
+      }
+    }
+    if (writeSlot_ == kNoSlot) {
+      return nullptr;
+    }
+  }
+  return slots_[writeSlot_].data.data() + kHeaderFloats;
+}
+
+inline std::uint8_t* RingBuffer::writeColumn(std::size_t column) {
+  return reinterpret_cast<std::uint8_t*>(slots_[writeSlot_].data.data()) + columnOffsets_[column];
+}
+
+inline void RingBuffer::commit(std::size_t count, double julianDate) {
+  if (writeSlot_ == kNoSlot && writePtr() == nullptr) {
+    return;
+  }
+  Slot& slot = slots_[writeSlot_];
+  count = std::min(count, capacity_);
+  ++nextSequence_;
+  const FrameHeader header{static_cast<double>(nextSequence_),
+                           julianDate,
+                           static_cast<double>(count),
+                           static_cast<double>(writeSlot_),
+                           static_cast<double>(layout_.format),
+                           static_cast<double>(capacity_),
+                           {static_cast<double>(columnOffsets_[1]), static_cast<double>(columnOffsets_[2])}};
+  std::memcpy(slot.data.data(), &header, sizeof(header));
+  slot.count.store(count, std::memory_order_relaxed);
+  slot.sequence.store(nextSequence_, std::memory_order_relaxed);
+  latest_.store(writeSlot_);
+  writeSlot_ = kNoSlot;
 }
 
-inline void RingBuffer::commit(std::size_t count) {
-  if (count > capacity_) {
-    count = capacity_;
+inline RingBuffer::Frame RingBuffer::acquire() {
+  for (;;) {
+    const std::uint32_t s = latest_.load();
+    if (s == kNoSlot) {
+      return {};
+    }
+    Slot& slot = slots_[s];
+    slot.pins.fetch_add(1);
+    // Still the latest after pinning, so the producer cannot be writing it.
+    if (latest_.load() == s) {
+      return {s,
+              slot.sequence.load(std::memory_order_relaxed),
+              slot.data.data() + kHeaderFloats,
+              slot.count.load(std::memory_order_relaxed)};
+    }
+    slot.pins.fetch_sub(1);
+  }
+}
+
+inline void RingBuffer::release(std::uint32_t slot) {
+  if (slot < slotCount_) {
+    slots_[slot].pins.fetch_sub(1, std::memory_order_release);
   }
-  count_ = count;
-  std::swap(front_, back_);
 }
 
 inline const float* RingBuffer::readPtr() const {
-  return front_.data();
+  const std::uint32_t s = latest_.load(std::memory_order_acquire);
+  return slotData(s == kNoSlot ? 0 : s);
 }
 
 inline std::span<const float> RingBuffer::readSpan() const {
-  return std::span<const float>(front_.data(), count_ * stride_);
+  return std::span<const float>(readPtr(), count() * layout_.columnBytes[0] / sizeof(float));
+}
+
+inline std::size_t RingBuffer::count() const {
+  const std::uint32_t s = latest_.load(std::memory_order_acquire);
+  return s == kNoSlot ? 0 : slots_[s].count.load(std::memory_order_relaxed);
+}
+
+inline std::uint64_t RingBuffer::sequence() const {
+  const std::uint32_t s = latest_.load(std::memory_order_acquire);
+  return s == kNoSlot ? 0 : slots_[s].sequence.load(std::memory_order_relaxed);
 }
 
 inline std::size_t RingBuffer::stride() const {
   return stride_;
 }
 
-inline std::size_t RingBuffer::count() const {
-  return count_;
+inline std::size_t RingBuffer::capacity() const {
+  return capacity_;
+}
+
+inline std::size_t RingBuffer::slotCount() const {
+  return slotCount_;
+}
+
+inline const float* RingBuffer::slotData(std::uint32_t slot) const {
+  return slots_[slot].data.data() + kHeaderFloats;
+}
+
+inline std::size_t RingBuffer::columnOffset(std::size_t column) const {
+  return columnOffsets_[column];
+}
+
+inline const std::uint8_t* RingBuffer::slotBytes(std::uint32_t slot) const {
+  return reinterpret_cast<const std::uint8_t*>(slots_[slot].data.data());
 }
 
 inline std::size_t RingBuffer::byteLength() const {
-  return front_.size() * sizeof(float);
+  return slotFloats_ * sizeof(float);
+}
+
+inline RingBuffer::FrameHeader RingBuffer::header(std::uint32_t slot) const {
+  FrameHeader header;
+  std::memcpy(&header, slots_[slot].data.data(), sizeof(header));
+  return header;
 }
 
 }  // namespace astro
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace astro {
+
+// Persistent helper threads for splitting a frame into independent tasks.
+// Threads are spawned once and parked on a condition variable between frames;
+// the calling thread participates in every parallelFor.
+class WorkerPool {
+ public:
+  explicit WorkerPool(std::size_t helperThreads);
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  // Total threads sharing the work, including the caller.
+  std::size_t concurrency() const noexcept {
+    return threads_.size() + 1;
+  }
+
+  // Invokes fn(task) for every task in [0, taskCount) and returns once all
+  // of them have finished.
+  template <typename Fn>
+  void parallelFor(std::size_t taskCount, Fn& fn) {
+    run(taskCount, [](void* context, std::size_t task) { (*static_cast<Fn*>(context))(task); }, &fn);
+  }
+
+ private:
+  using TaskFn = void (*)(void*, std::size_t);
+
+  void run(std::size_t taskCount, TaskFn fn, void* context);
+  void drainTasks();
+  void workerLoop();
+
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable idle_;
+  std::uint64_t generation_{0};
+  std::size_t busyWorkers_{0};
+  bool stopping_{false};
+
+  TaskFn fn_{nullptr};
+  void* context_{nullptr};
+  std::size_t taskCount_{0};
+  std::atomic<std::size_t> nextTask_{0};
+};
+
+}  // namespace astro
@@ -0,0 +1,399 @@
+#include "astro/catalog.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+
+#include "MappedFile.hpp"
+#include "astro/vector.hpp"
+
+namespace astro {
+
+namespace {
+
+// Uniform access to the two input layouts.
+struct StarInSource {
+  std::span<const StarIn> stars;
+
+  std::size_t size() const {
+    return stars.size();
+  }
+  StarIn operator[](std::size_t i) const {
+    return stars[i];
+  }
+};
+
+struct PackedSource {
+  std::span<const float> records;
+
+  std::size_t size() const {
+    return records.size() / kPackedStarFloats;
+  }
+  StarIn operator[](std::size_t i) const {
+    const float* record = records.data() + i * kPackedStarFloats;
+    return {record[0], record[1], record[2], static_cast<int>(record[3]), std::numeric_limits<double>::quiet_NaN()};
+  }
+};
+
+template <typename T>
+void gather(AlignedVector<T>& column, const std::vector<std::uint32_t>& order) {
+  AlignedVector<T> sorted(order.size());
+  for (std::size_t slot = 0; slot < order.size(); ++slot) {
+    sorted[slot] = column[order[slot]];
+  }
+  column.swap(sorted);
+}
+
+}  // namespace
+
+void StarCatalog::assign(std::span<const StarIn> stars, const CatalogOptions& options) {
+  assignFrom(StarInSource{stars}, options);
+}
+
+void StarCatalog::assignPacked(std::span<const float> records, const CatalogOptions& options) {
+  assignFrom(PackedSource{records}, options);
+}
+
+bool StarCatalog::update(std::size_t first, std::span<const StarIn> stars) {
+  return updateFrom(first, StarInSource{stars});
+}
+
+bool StarCatalog::updatePacked(std::size_t first, std::span<const float> records) {
+  return updateFrom(first, PackedSource{records});
+}
+
+bool StarCatalog::updateColors(std::size_t first, std::span<const float> bv) {
+  if (first > size_ || bv.size() > size_ - first) {
+    return false;
+  }
+  // Colors do not affect the layout or the index.
+  makeOwned();
+  for (std::size_t k = 0; k < bv.size(); ++k) {
+    ownedBv_[slotOf_[first + k]] = bv[k];
+  }
+  return true;
+}
+
+std::uint32_t StarCatalog::slotOf(std::size_t i) const {
+  return slotOf_.empty() ? static_cast<std::uint32_t>(i) : slotOf_[i];
+}
+
+template <typename Source>
+void StarCatalog::assignFrom(const Source& stars, const CatalogOptions& options) {
+  const std::size_t count = stars.size();
+  file_.reset();
+  ownedX_.resize(count);
+  ownedY_.resize(count);
+  ownedZ_.resize(count);
+  ownedMag_.resize(count);
+  ownedHip_.resize(count);
+  ownedBv_.resize(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    const StarIn star = stars[i];
+    const Vec3 direction = vector::equatorialToUnit(star.raDeg, star.decDeg);
+    ownedX_[i] = static_cast<float>(direction.x);
+    ownedY_[i] = static_cast<float>(direction.y);
+    ownedZ_[i] = static_cast<float>(direction.z);
+    ownedMag_[i] = static_cast<float>(star.mag);
+    ownedHip_[i] = static_cast<std::int32_t>(star.hip);
+    ownedBv_[i] = static_cast<float>(star.bv);
+  }
+  inputOf_.resize(count);
+  std::iota(inputOf_.begin(), inputOf_.end(), 0u);
+  sortedByMagnitude_ = options.sortByMagnitude;
+  arrange(std::clamp(options.indexLevels, 0, SkyIndex::kMaxLevels));
+}
+
+template <typename Source>
+bool StarCatalog::updateFrom(std::size_t first, const Source& stars) {
+  if (first > size_ || stars.size() > size_ - first) {
+    return false;
+  }
+  makeOwned();
+
+  const int levels = index_.levels();
+  std::vector<std::uint32_t> touched;
+  touched.reserve(stars.size());
+  bool crossedLeaves = false;
+  for (std::size_t k = 0; k < stars.size(); ++k) {
+    const std::uint32_t slot = slotOf_[first + k];
+    const StarIn star = stars[k];
+    const Vec3 direction = vector::equatorialToUnit(star.raDeg, star.decDeg);
+    const std::uint32_t oldLeaf = SkyIndex::leafOf(levels, ownedX_[slot], ownedY_[slot], ownedZ_[slot]);
+    ownedX_[slot] = static_cast<float>(direction.x);
+    ownedY_[slot] = static_cast<float>(direction.y);
+    ownedZ_[slot] = static_cast<float>(direction.z);
+    ownedMag_[slot] = static_cast<float>(star.mag);
+    ownedHip_[slot] = static_cast<std::int32_t>(star.hip);
+    if (!std::isnan(star.bv)) {
+      ownedBv_[slot] = static_cast<float>(star.bv);
+    }
+    const std::uint32_t leaf = SkyIndex::leafOf(levels, ownedX_[slot], ownedY_[slot], ownedZ_[slot]);
+    crossedLeaves = crossedLeaves || leaf != oldLeaf;
+    touched.push_back(leaf);
+  }
+
+  // A star that moved to another tile changes the storage layout; redo it
+  // from the columns, which is still far cheaper than a full assign.
+  if (crossedLeaves) {
+    arrange(levels);
+    return true;
+  }
+
+  std::sort(touched.begin(), touched.end());
+  touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+  if (sortedByMagnitude_) {
+    const auto leafTiles = index_.level(levels);
+    for (const std::uint32_t leaf : touched) {
+      const SkyTile& tile = leafTiles[leaf];
+      const std::span<float> mags(ownedMag_.data() + tile.begin, tile.end - tile.begin);
+      if (std::is_sorted(mags.begin(), mags.end())) {
+        continue;
+      }
+      std::vector<std::uint32_t> order(tile.end - tile.begin);
+      std::iota(order.begin(), order.end(), tile.begin);
+      std::stable_sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) {
+        return ownedMag_[a] < ownedMag_[b];
+      });
+      permuteSlots(tile.begin, order);
+    }
+  }
+  index_.refit(touched, x_, y_, z_, mag_);
+  return true;
+}
+
+void StarCatalog::arrange(int levels) {
+  const std::size_t count = ownedMag_.size();
+
+  // Counting sort by sky-index leaf; stable, so the current order is kept
+  // within a leaf.
+  std::vector<std::uint32_t> leaves(count);
+  std::vector<std::uint32_t> leafBegin(SkyIndex::leafCount(levels) + 1, 0);
+  for (std::size_t i = 0; i < count; ++i) {
+    leaves[i] = SkyIndex::leafOf(levels, ownedX_[i], ownedY_[i], ownedZ_[i]);
+    leafBegin[leaves[i] + 1] += 1;
+  }
+  for (std::size_t leaf = 1; leaf < leafBegin.size(); ++leaf) {
+    leafBegin[leaf] += leafBegin[leaf - 1];
+  }
+
+  std::vector<std::uint32_t> order(count);
+  std::vector<std::uint32_t> cursor(leafBegin.begin(), leafBegin.end() - 1);
+  for (std::size_t i = 0; i < count; ++i) {
+    order[cursor[leaves[i]]++] = static_cast<std::uint32_t>(i);
+  }
+
+  // Brightest first inside each leaf, so a limiting magnitude becomes a
+  // binary search per leaf instead of a test per star.
+  if (sortedByMagnitude_) {
+    for (std::size_t leaf = 0; leaf + 1 < leafBegin.size(); ++leaf) {
+      std::stable_sort(order.begin() + leafBegin[leaf],
+                       order.begin() + leafBegin[leaf + 1],
+                       [&](std::uint32_t a, std::uint32_t b) { return ownedMag_[a] < ownedMag_[b]; });
+    }
+  }
+
+  gather(ownedX_, order);
+  gather(ownedY_, order);
+  gather(ownedZ_, order);
+  gather(ownedMag_, order);
+  gather(ownedHip_, order);
+  gather(ownedBv_, order);
+  std::vector<std::uint32_t> inputOf(count);
+  slotOf_.resize(count);
+  for (std::size_t slot = 0; slot < count; ++slot) {
+    inputOf[slot] = inputOf_[order[slot]];
+    slotOf_[inputOf[slot]] = static_cast<std::uint32_t>(slot);
+  }
+  inputOf_.swap(inputOf);
+
+  pointAtOwned();
+  index_.build(levels, leafBegin, x_, y_, z_, mag_);
+}
+
+void StarCatalog::permuteSlots(std::uint32_t begin, std::span<const std::uint32_t> order) {
+  auto apply = [&](auto& column) {
+    using T = typename std::remove_reference_t<decltype(column)>::value_type;
+    std::vector<T> moved(order.size());
+    for (std::size_t k = 0; k < order.size(); ++k) {
+      moved[k] = column[order[k]];
+    }
+    std::copy(moved.begin(), moved.end(), column.begin() + begin);
+  };
+  apply(ownedX_);
+  apply(ownedY_);
+  apply(ownedZ_);
+  apply(ownedMag_);
+  apply(ownedHip_);
+  apply(ownedBv_);
+  apply(inputOf_);
+  for (std::size_t k = 0; k < order.size(); ++k) {
+    slotOf_[inputOf_[begin + k]] = static_cast<std::uint32_t>(begin + k);
+  }
+}
+
+void StarCatalog::makeOwned() {
+  if (!file_) {
+    return;
+  }
+  // Stars of a mapped catalog are addressed in file order.
+  ownedX_.assign(x_, x_ + size_);
+  ownedY_.assign(y_, y_ + size_);
+  ownedZ_.assign(z_, z_ + size_);
+  ownedMag_.assign(mag_, mag_ + size_);
+  ownedHip_.assign(hip_, hip_ + size_);
+  if (bv_ != nullptr) {
+    ownedBv_.assign(bv_, bv_ + size_);
+  } else {
+    ownedBv_.assign(size_, std::numeric_limits<float>::quiet_NaN());
+  }
+  inputOf_.resize(size_);
+  std::iota(inputOf_.begin(), inputOf_.end(), 0u);
+  slotOf_ = inputOf_;
+  file_.reset();
+  pointAtOwned();
+}
+
+void StarCatalog::pointAtOwned() {
+  x_ = ownedX_.data();
+  y_ = ownedY_.data();
+  z_ = ownedZ_.data();
+  mag_ = ownedMag_.data();
+  hip_ = ownedHip_.data();
+  bv_ = ownedBv_.data();
+  size_ = ownedMag_.size();
+}
+
+CatalogFileStatus StarCatalog::load(const std::string& path) {
+  static_assert(std::endian::native == std::endian::little,
+                "catalog files are little-endian and their sections are used in place");
+
+  std::shared_ptr<const MappedFile> file = MappedFile::open(path);
+  if (!file) {
+    return CatalogFileStatus::OpenFailed;
+  }
+  CatalogFileHeader header{};
+  if (file->size() < kCatalogFileHeaderV1Bytes) {
+    return CatalogFileStatus::Truncated;
+  }
+  std::memcpy(&header, file->data(), kCatalogFileHeaderV1Bytes);
+  if (std::memcmp(header.magic, kCatalogFileMagic, sizeof(header.magic)) != 0) {
+    return CatalogFileStatus::BadMagic;
+  }
+  if (header.version == 0 || header.version > kCatalogFileVersion) {
+    return CatalogFileStatus::UnsupportedVersion;
+  }
+  if (header.version > 1) {
+    if (file->size() < sizeof(header)) {
+      return CatalogFileStatus::Truncated;
+    }
+    std::memcpy(&header, file->data(), sizeof(header));
+  }
+  if (header.indexLevels < 0 || header.indexLevels > SkyIndex::kMaxLevels ||
+      header.starCount > UINT32_MAX) {
+    return CatalogFileStatus::Corrupt;
+  }
+
+  const auto count = static_cast<std::size_t>(header.starCount);
+  bool truncated = false;
+  bool misaligned = false;
+  auto section = [&](std::uint64_t offset, std::size_t bytes) -> const std::byte* {
+    if (offset % kCacheLineSize != 0) {
+      misaligned = true;
+      return nullptr;
+    }
+    if (offset > file->size() || bytes > file->size() - offset) {
+      truncated = true;
+      return nullptr;
+    }
+    return file->data() + offset;
+  };
+  const auto* x = reinterpret_cast<const float*>(section(header.xOffset, count * sizeof(float)));
+  const auto* y = reinterpret_cast<const float*>(section(header.yOffset, count * sizeof(float)));
+  const auto* z = reinterpret_cast<const float*>(section(header.zOffset, count * sizeof(float)));
+  const auto* mag = reinterpret_cast<const float*>(section(header.magOffset, count * sizeof(float)));
+  const auto* hip =
+      reinterpret_cast<const std::int32_t*>(section(header.hipOffset, count * sizeof(std::int32_t)));
+  const auto* bv = header.bvOffset == 0
+                       ? nullptr
+                       : reinterpret_cast<const float*>(section(header.bvOffset, count * sizeof(float)));
+  const auto* tiles = header.tileCount == 0
+                          ? nullptr
+                          : reinterpret_cast<const SkyTile*>(
+                                section(header.tilesOffset, header.tileCount * sizeof(SkyTile)));
+  if (truncated) {
+    return CatalogFileStatus::Truncated;
+  }
+  if (misaligned) {
+    return CatalogFileStatus::Corrupt;
+  }
+
+  const int levels = header.indexLevels;
+  SkyIndex index;
+  if (tiles != nullptr) {
+    if (!index.assign(levels, std::span<const SkyTile>(tiles, header.tileCount), count)) {
+      return CatalogFileStatus::Corrupt;
+    }
+  } else {
+    // No stored index: the stars must already be in leaf order.
+    std::vector<std::uint32_t> leafBegin(SkyIndex::leafCount(levels) + 1, 0);
+    std::uint32_t previous = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+      const std::uint32_t leaf = SkyIndex::leafOf(levels, x[i], y[i], z[i]);
+      if (leaf < previous) {
+        return CatalogFileStatus::Corrupt;
+      }
+      previous = leaf;
+      leafBegin[leaf + 1] += 1;
+    }
+    for (std::size_t leaf = 1; leaf < leafBegin.size(); ++leaf) {
+      leafBegin[leaf] += leafBegin[leaf - 1];
+    }
+    index.build(levels, leafBegin, x, y, z, mag);
+  }
+
+  clear();
+  file_ = std::move(file);
+  x_ = x;
+  y_ = y;
+  z_ = z;
+  mag_ = mag;
+  hip_ = hip;
+  bv_ = bv;
+  size_ = count;
+  index_ = std::move(index);
+  sortedByMagnitude_ = (header.flags & kCatalogFileSortedByMagnitude) != 0;
+  return CatalogFileStatus::Ok;
+}
+
+void StarCatalog::collect(const SkyCone& view,
+                          const SkyCone& horizon,
+                          double limitingMag,
+                          std::vector<StarRange>& out) const {
+  index_.collect(view, horizon, limitingMag, sortedByMagnitude_ ? mag_ : nullptr, out);
+}
+
+void StarCatalog::clear() {
+  // Release the memory rather than keep capacity around for the next catalog.
+  ownedX_ = {};
+  ownedY_ = {};
+  ownedZ_ = {};
+  ownedMag_ = {};
+  ownedHip_ = {};
+  ownedBv_ = {};
+  inputOf_ = {};
+  slotOf_ = {};
+  file_.reset();
+  x_ = y_ = z_ = mag_ = nullptr;
+  hip_ = nullptr;
+  bv_ = nullptr;
+  size_ = 0;
+  index_.clear();
+  sortedByMagnitude_ = false;
+}
+
+}  // namespace astro
@@ -0,0 +1,89 @@
+#include "astro/catalog_file.hpp"
+
+#include <cstring>
+#include <fstream>
+
+#include "astro/catalog.hpp"
+
+namespace astro {
+
+namespace {
+std::uint64_t alignUp(std::uint64_t offset) {
+  return (offset + kCacheLineSize - 1) / kCacheLineSize * kCacheLineSize;
+}
+}  // namespace
+
+const char* describe(CatalogFileStatus status) {
+  switch (status) {
+    case CatalogFileStatus::Ok:
+      return "ok";
+    case CatalogFileStatus::OpenFailed:
+      return "file could not be opened or mapped";
+    case CatalogFileStatus::BadMagic:
+      return "not an AstroCore catalog file";
+    case CatalogFileStatus::UnsupportedVersion:
+      return "unsupported catalog file version";
+    case CatalogFileStatus::Truncated:
+      return "catalog file is truncated";
+    case CatalogFileStatus::Corrupt:
+      return "catalog file is corrupt";
+    case CatalogFileStatus::WriteFailed:
+      return "catalog file could not be written";
+  }
+  return "unknown catalog file status";
+}
+
+CatalogFileStatus writeCatalogFile(const std::string& path, const StarCatalog& catalog, bool includeTiles) {
+  const std::size_t count = catalog.size();
+  const std::span<const SkyTile> tiles = includeTiles ? catalog.index().tiles() : std::span<const SkyTile>{};
+
+  CatalogFileHeader header{};
+  std::memcpy(header.magic, kCatalogFileMagic, sizeof(header.magic));
+  header.version = kCatalogFileVersion;
+  header.flags = catalog.sortedByMagnitude() ? kCatalogFileSortedByMagnitude : 0;
+  header.starCount = count;
+  header.indexLevels = catalog.index().levels();
+  header.tileCount = static_cast<std::uint32_t>(tiles.size());
+
+  std::uint64_t offset = sizeof(header);
+  auto place = [&offset](std::uint64_t bytes) {
+    const std::uint64_t at = alignUp(offset);
+    offset = at + bytes;
+    return at;
+  };
+  header.xOffset = place(count * sizeof(float));
+  header.yOffset = place(count * sizeof(float));
+  header.zOffset = place(count * sizeof(float));
+  header.magOffset = place(count * sizeof(float));
+  header.hipOffset = place(count * sizeof(std::int32_t));
+  header.bvOffset = catalog.bv() == nullptr ? 0 : place(count * sizeof(float));
+  header.tilesOffset = tiles.empty() ? 0 : place(tiles.size_bytes());
+
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    return CatalogFileStatus::WriteFailed;
+  }
+  std::uint64_t written = 0;
+  auto write = [&](std::uint64_t at, const void* data, std::size_t bytes) {
+    static constexpr char kPadding[kCacheLineSize] = {};
+    out.write(kPadding, static_cast<std::streamsize>(at - written));
+    out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+    written = at + bytes;
+  };
+  write(0, &header, sizeof(header));
+  write(header.xOffset, catalog.x(), count * sizeof(float));
+  write(header.yOffset, catalog.y(), count * sizeof(float));
+  write(header.zOffset, catalog.z(), count * sizeof(float));
+  write(header.magOffset, catalog.mag(), count * sizeof(float));
+  write(header.hipOffset, catalog.hip(), count * sizeof(std::int32_t));
+  if (header.bvOffset != 0) {
+    write(header.bvOffset, catalog.bv(), count * sizeof(float));
+  }
+  if (!tiles.empty()) {
+    write(header.tilesOffset, tiles.data(), tiles.size_bytes());
+  }
+  out.close();
+  return out ? CatalogFileStatus::Ok : CatalogFileStatus::WriteFailed;
+}
+
+}  // namespace astro
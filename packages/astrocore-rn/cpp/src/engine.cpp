@@ -1,12 +1,20 @@
 #include "astro/engine.hpp"
 
 #include <algorithm>
+#include <array>
+#include <chrono>
 #include <cmath>
+#include <cstring>
 #include <numeric>
 
+#include "FrameFormat.hpp"
+#include "ProjectionKernel.hpp"
 #include "RingBuffer.hpp"
+#include "WorkerPool.hpp"
+#include "astro/FrameClock.hpp"
 #include "astro/Quaternion.hpp"
 #include "astro/time.hpp"
+#include "astro/trace.hpp"
 #include "astro/transform.hpp"
 #include "astro/vector.hpp"
 
@@ -14,92 +22,603 @@ namespace astro {
 
 namespace {
 constexpr std::size_t kStride = ASTRO_RINGBUFFER_STRIDE;
+static_assert(kStride == 4, "projection kernels emit (x, y, mag, hip) records");
+
+// Below this many stars per slice the hand-off costs more than it saves.
+constexpr std::size_t kMinStarsPerSlice = 2048;
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kHalfPi = kPi * 0.5;
+constexpr double kDegToRad = 0.01745329251994329577;
+// Earth turns 1.00273790935 times per solar day relative to the stars.
+constexpr double kSiderealRadPerDay = 2.0 * kPi * 1.00273790935;
+// Refraction lifts a star by at most ~0.83 deg (at -1 deg altitude) under
+// reference conditions; the margin grows with the refraction factor.
+constexpr double kCullMarginRad = 0.01745329251994329577;
+
+// Laps of the frame's stages for FrameStats; does nothing unless enabled.
+class StageTimer {
+ public:
+  explicit StageTimer(bool enabled) : enabled_(enabled) {
+    if (enabled_) {
+      last_ = Clock::now();
+    }
+  }
+
+  bool enabled() const {
+    return enabled_;
+  }
+
+  void lap(FrameSample& sample, FrameStage stage) {
+    if (!enabled_) {
+      return;
+    }
+    const Clock::time_point now = Clock::now();
+    sample.stageMicros[static_cast<std::size_t>(stage)] =
+        std::chrono::duration<float, std::micro>(now - last_).count();
+    last_ = now;
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  bool enabled_;
+  Clock::time_point last_{};
+};
+
+void setCounter(FrameSample& sample, FrameCounter counter, std::size_t value) {
+  sample.counters[static_cast<std::size_t>(counter)] = static_cast<std::uint32_t>(value);
 }
 
+// Projects positions [first, last) of the concatenation of `ranges`.
+std::size_t projectRanges(ProjectionKernel kernel,
+                          const ProjectionParams& params,
+                          const CatalogColumns& columns,
+                          std::span<const StarRange> ranges,
+                          std::size_t first,
+                          std::size_t last,
+                          float* out,
+                          std::size_t capacity) {
+  std::size_t count = 0;
+  std::size_t position = 0;
+  for (const StarRange& range : ranges) {
+    const std::size_t length = range.end - range.begin;
+    if (position >= last || count >= capacity) {
+      break;
+    }
+    if (position + length > first) {
+      const std::size_t begin = range.begin + (first > position ? first - position : 0);
+      const std::size_t end = range.begin + std::min(length, last - position);
+      count += kernel(params, columns, begin, end, out + count * kStride, capacity - count);
+    }
+    position += length;
+  }
+  return count;
+}
+
+ProjectionParams makeProjectionParams(const Mat3& equatorialToDevice,
+                                      const Vec3& zenith,
+                                      const Vec3& deviceUp,
+                                      const ScreenProjection& projection,
+                                      const transform::RefractionTable* refraction,
+                                      double limitingMag,
+                                      bool filterMagnitude) {
+  ProjectionParams params{};
+  for (int r = 0; r < 3; ++r) {
+    for (int c = 0; c < 3; ++c) {
+      params.toDevice[r][c] = static_cast<float>(equatorialToDevice.m[r][c]);
+    }
+  }
+  params.zenith[0] = static_cast<float>(zenith.x);
+  params.zenith[1] = static_cast<float>(zenith.y);
+  params.zenith[2] = static_cast<float>(zenith.z);
+  params.deviceUp[0] = static_cast<float>(deviceUp.x);
+  params.deviceUp[1] = static_cast<float>(deviceUp.y);
+  params.deviceUp[2] = static_cast<float>(deviceUp.z);
+  params.halfWidth = static_cast<float>(projection.halfWidth);
+  params.halfHeight = static_cast<float>(projection.halfHeight);
+  params.focalLength = static_cast<float>(projection.focalLength);
+  params.width = projection.width;
+  params.height = projection.height;
+  params.limitingMag = static_cast<float>(limitingMag);
+  params.filterMagnitude = filterMagnitude;
+  params.refraction = refraction;
+  params.rawIds = false;
+  params.counters = nullptr;
+  return params;
+}
+}  // namespace
+
 AstroEngine::AstroEngine()
     : ringBuffer_(std::make_unique<RingBuffer>()) {
-  ringBuffer_->configure(kStride, ASTRO_MAX_STARS);
+  ringBuffer_->configure(kStride, ASTRO_MAX_STARS, RingBuffer::kDefaultSlots, kMaxFrameRecordBytes);
+  ringBuffer_->setLayout(frameLayout(FrameFormat::Float32));
 }
 
-AstroEngine::~AstroEngine() = default;
+AstroEngine::~AstroEngine() {
+  stopFrameLoop();
+}
 
 void AstroEngine::setConfig(const EngineConfig& config) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (config.apparentPlaces != config_.apparentPlaces) {
+    siderealCache_.valid = false;
+  }
   config_ = config;
   if (config_.fovDeg <= 0.0) {
     config_.fovDeg = ASTRO_DEFAULT_FOV_DEG;
   }
   configReady_ = config_.screen.width > 0 && config_.screen.height > 0;
+  // The slots are sized for the widest format, so switching never moves them.
+  ringBuffer_->setLayout(frameLayout(config_.frameFormat));
+
+  const auto threads =
+      static_cast<std::size_t>(std::clamp(config_.workerThreads, 1, ASTRO_MAX_WORKER_THREADS));
+  if (threads == 1) {
+    workers_.reset();
+  } else if (!workers_ || workers_->concurrency() != threads) {
+    workers_ = std::make_unique<WorkerPool>(threads - 1);
+  }
 }
 
 void AstroEngine::setObserver(const Observer& observer) {
+  std::lock_guard<std::mutex> lock(mutex_);
   observer_ = observer;
+  siderealCache_.valid = false;
+  const double factor = transform::refractionFactor(observer_);
+  if (factor != refraction_.factor()) {
+    refraction_ = transform::RefractionTable(factor);
+  }
+}
+
+// Catalogs are built outside the lock so a running frame loop keeps
+// rendering the old one meanwhile; the old one is freed after the swap.
+void AstroEngine::setStars(std::span<const StarIn> stars, const CatalogOptions& options) {
+  trace::Span span("catalog", "setStars");
+  span.setCount(static_cast<std::int64_t>(stars.size()));
+  StarCatalog catalog;
+  catalog.assign(stars, options);
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::swap(catalog_, catalog);
+}
+
+void AstroEngine::setPackedStars(std::span<const float> records, const CatalogOptions& options) {
+  trace::Span span("catalog", "setPackedStars");
+  StarCatalog catalog;
+  catalog.assignPacked(records, options);
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::swap(catalog_, catalog);
 }
 
-void AstroEngine::setStars(std::span<const StarIn> stars) {
-  catalog_.assign(stars.begin(), stars.end());
-  output_.resize(catalog_.size());
+bool AstroEngine::updateStars(std::size_t first, std::span<const StarIn> stars) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return catalog_.update(first, stars);
+}
+
+bool AstroEngine::updatePackedStars(std::size_t first, std::span<const float> records) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return catalog_.updatePacked(first, records);
+}
+
+bool AstroEngine::setStarColors(std::size_t first, std::span<const float> bv) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return catalog_.updateColors(first, bv);
+}
+
+std::size_t AstroEngine::starCount() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return catalog_.size();
+}
+
+CatalogFileStatus AstroEngine::loadCatalog(const std::string& path) {
+  trace::Span span("catalog", "loadCatalog");
+  StarCatalog catalog;
+  const CatalogFileStatus status = catalog.load(path);
+  span.setCount(static_cast<std::int64_t>(catalog.size()));
+  if (status == CatalogFileStatus::Ok) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::swap(catalog_, catalog);
+  }
+  return status;
+}
+
+void AstroEngine::setLimitingMag(double limitingMag) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  config_.limitingMag = limitingMag;
+}
+
+double AstroEngine::effectiveLimitingMag() const {
+  if (!config_.limitingMagFollowsFov) {
+    return config_.limitingMag;
+  }
+  // Narrowing the view by a factor k spreads the same light budget over k^2
+  // less sky, i.e. 2.5 * log10(k^2) magnitudes deeper.
+  return config_.limitingMag + 5.0 * std::log10(ASTRO_DEFAULT_FOV_DEG / config_.fovDeg);
 }
 
 void AstroEngine::updatePose(const PoseQuat& pose) {
-  pose_ = pose;
+  std::shared_ptr<FrameClock> clock;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pose_ = pose;
+    poseHistory_.clear();
+    if (framePerPose_) {
+      clock = clock_;
+    }
+  }
+  if (clock) {
+    clock->wake();
+  }
 }
 
-std::size_t AstroEngine::computeFrame(double jd) {
-  if (!configReady_ || catalog_.empty()) {
-    ringBuffer_->commit(0);
-    return 0;
+void AstroEngine::pushPose(double unixMs, const PoseQuat& pose) {
+  std::shared_ptr<FrameClock> clock;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pose_ = pose;
+    poseHistory_.push(unixMs, pose);
+    if (framePerPose_) {
+      clock = clock_;
+    }
+  }
+  if (clock) {
+    clock->wake();
   }
+}
 
-  const double lst = time::localSiderealTimeRad(jd, observer_.lonDeg);
-  const Quaternion orientation = Quaternion::fromPose(pose_);
+PoseQuat AstroEngine::poseAt(double unixMs) const {
+  PoseQuat pose;
+  return poseHistory_.poseAt(unixMs, config_.maxPoseLeadMs, pose) ? pose : pose_;
+}
 
-  float* writePtr = ringBuffer_->writePtr();
-  std::size_t visibleCount = 0;
+void AstroEngine::startFrameLoop(std::shared_ptr<FrameClock> clock, bool framePerPose) {
+  std::lock_guard<std::mutex> loopLock(loopMutex_);
+  joinFrameLoop();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    clock_ = clock;
+    framePerPose_ = framePerPose;
+  }
+  frameThread_ = std::thread([this, clock = std::move(clock)] {
+    trace::setThreadName("astro-frame-loop");
+    std::int64_t unixMs = 0;
+    while (clock->wait(unixMs)) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      renderFrame(time::unixMillisToJulianDate(unixMs),
+                  poseAt(static_cast<double>(unixMs) + config_.displayLatencyMs));
+    }
+  });
+}
+
+void AstroEngine::stopFrameLoop() {
+  std::lock_guard<std::mutex> loopLock(loopMutex_);
+  joinFrameLoop();
+}
+
+bool AstroEngine::frameLoopRunning() const {
+  std::lock_guard<std::mutex> loopLock(loopMutex_);
+  return frameThread_.joinable();
+}
 
-  for (std::size_t i = 0; i < catalog_.size(); ++i) {
-    const StarIn& star = catalog_[i];
-    StarOut& out = output_[i];
+void AstroEngine::joinFrameLoop() {
+  std::shared_ptr<FrameClock> clock;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    clock = std::move(clock_);
+    framePerPose_ = false;
+  }
+  if (clock) {
+    clock->stop();
+  }
+  if (frameThread_.joinable()) {
+    frameThread_.join();
+  }
+}
 
-    Horizontal horizontal = transform::equatorialToHorizontal(
-        star.raDeg, star.decDeg, lst, observer_.latDeg);
+void AstroEngine::clearFrame() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ringBuffer_->commit(0);
+}
 
-    if (config_.applyRefraction) {
-      horizontal.altRad = transform::applyRefraction(horizontal.altRad);
+const Mat3& AstroEngine::siderealRotation(double jd) {
+  // Between two frames the sky turns by a few thousandths of a degree while
+  // the pose can swing freely; keep the equatorial->ENU rotation until the
+  // sidereal angle has drifted past the tolerance.
+  // The apparent frame moves far slower still and is kept for
+  // apparentFrameIntervalDays; a new one also rebuilds the rotation.
+  if (config_.apparentPlaces &&
+      (!apparentCache_.valid || !(std::fabs(jd - apparentCache_.jd) <= config_.apparentFrameIntervalDays))) {
+    apparentCache_.frame = transform::apparentFrame(jd);
+    apparentCache_.jd = jd;
+    apparentCache_.valid = true;
+    siderealCache_.valid = false;
+  }
+  const double driftRad = std::fabs(jd - siderealCache_.jd) * kSiderealRadPerDay;
+  if (!siderealCache_.valid || !(driftRad <= config_.siderealToleranceDeg * kDegToRad)) {
+    const double lst = time::localSiderealTimeRad(jd, observer_.lonDeg);
+    if (config_.apparentPlaces) {
+      const transform::ApparentFrame& frame = apparentCache_.frame;
+      const Mat3 ofDateToENU =
+          transform::equatorialToENUMatrix(lst + frame.equationOfEquinoxesRad, observer_.latDeg);
+      siderealCache_.equatorialToENU = ofDateToENU * frame.biasPrecessionNutation;
+      siderealCache_.aberrationENU = ofDateToENU * frame.aberration;
+    } else {
+      siderealCache_.equatorialToENU = transform::equatorialToENUMatrix(lst, observer_.latDeg);
+      siderealCache_.aberrationENU = {};
     }
+    siderealCache_.jd = jd;
+    siderealCache_.valid = true;
+  }
+  return siderealCache_.equatorialToENU;
+}
 
-    out.visible = horizontal.altRad > 0.0;
-    out.hip = star.hip;
-    out.mag = static_cast<float>(star.mag);
-    out.x = 0.0f;
-    out.y = 0.0f;
+std::size_t AstroEngine::computeFrame(double jd) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return renderFrame(jd, pose_);
+}
 
-    if (!out.visible) {
-      continue;
+std::size_t AstroEngine::computeFrame(double jd, const PoseQuat& pose) {
+  std::shared_ptr<FrameClock> clock;
+  std::size_t visible = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pose_ = pose;
+    poseHistory_.clear();
+    visible = renderFrame(jd, pose_);
+    if (framePerPose_) {
+      clock = clock_;
     }
+  }
+  if (clock) {
+    clock->wake();
+  }
+  return visible;
+}
 
-    const Vec3 enu = vector::horizontalToENU(horizontal);
-    const Vec3 deviceVec = vector::rotateToDevice(enu, orientation);
+std::size_t AstroEngine::computeFrame(std::span<const double> samples) {
+  const std::size_t count = samples.size() / kPoseSampleDoubles;
+  if (count == 0) {
+    return 0;
+  }
+  std::shared_ptr<FrameClock> clock;
+  std::size_t visible = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (std::size_t i = 0; i < count; ++i) {
+      const double* sample = samples.data() + i * kPoseSampleDoubles;
+      pose_ = {sample[1], sample[2], sample[3], sample[4]};
+      poseHistory_.push(sample[0], pose_);
+    }
+    const double newestUnixMs = samples[(count - 1) * kPoseSampleDoubles];
+    visible = renderFrame(time::unixMillisToJulianDate(static_cast<std::int64_t>(newestUnixMs)), pose_);
+    if (framePerPose_) {
+      clock = clock_;
+    }
+  }
+  if (clock) {
+    clock->wake();
+  }
+  return visible;
+}
+
+std::size_t AstroEngine::computeFrame(double jd, double displayUnixMs) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return renderFrame(jd, poseAt(displayUnixMs));
+}
 
-    float screenX = 0.0f;
-    float screenY = 0.0f;
-    out.visible = vector::projectToScreen(deviceVec, config_, screenX, screenY);
-    if (!out.visible) {
-      continue;
+std::size_t AstroEngine::renderFrame(double jd, const PoseQuat& pose) {
+  trace::Span frameSpan("engine", "frame");
+  if (!configReady_ || catalog_.empty()) {
+    ringBuffer_->commit(0, jd);
+    return 0;
+  }
+
+  StageTimer timer(kFrameStatsCompiled && config_.recordFrameStats);
+  FrameSample sample;
+
+  // Fold sidereal rotation, latitude and device pose into one matrix so each
+  // star costs a dot product for the horizon test and a mat-vec for projection.
+  Mat3 equatorialToENU = siderealRotation(jd);
+  timer.lap(sample, FrameStage::Sidereal);
+  const Mat3 enuToDevice = Quaternion::fromPose(pose).toMatrix();
+  if (config_.apparentPlaces) {
+    // Aberration moves a star at v to v + b, and the kernels only need the
+    // direction. Across the view dot(axis, v) stays close to 1, so the
+    // linear v + b * dot(axis, v) folds it into the rotation at no per-star
+    // cost. It is off by |b| (1 - cos) of the angle from the view axis: 7
+    // arcsec in the corners of a portrait screen with a 60 deg field, a few
+    // hundredths of a pixel.
+    const Vec3 axis = equatorialToENU.transposed() * enuToDevice.row(2);
+    const Vec3& b = siderealCache_.aberrationENU;
+    const double offset[3] = {b.x, b.y, b.z};
+    const double along[3] = {axis.x, axis.y, axis.z};
+    for (int r = 0; r < 3; ++r) {
+      for (int c = 0; c < 3; ++c) {
+        equatorialToENU.m[r][c] += offset[r] * along[c];
+      }
     }
+  }
+  const Mat3 equatorialToDevice = enuToDevice * equatorialToENU;
+  const ScreenProjection projection = vector::makeScreenProjection(config_);
+  const double limitingMag = effectiveLimitingMag();
+  const bool filterMagnitude = std::isfinite(limitingMag) && !catalog_.sortedByMagnitude();
+  ProjectionParams params = makeProjectionParams(equatorialToDevice,
+                                                 equatorialToENU.row(2),
+                                                 enuToDevice.column(2),
+                                                 projection,
+                                                 config_.applyRefraction ? &refraction_ : nullptr,
+                                                 limitingMag,
+                                                 filterMagnitude);
+  const FrameFormat format = config_.frameFormat;
+  const std::int32_t* ids = catalog_.hip();
+  if (format == FrameFormat::Vertex) {
+    if (slotNumbers_.size() < catalog_.size()) {
+      const std::size_t numbered = slotNumbers_.size();
+      slotNumbers_.resize(catalog_.size());
+      std::iota(slotNumbers_.begin() + static_cast<std::ptrdiff_t>(numbered),
+                slotNumbers_.end(),
+                static_cast<std::int32_t>(numbered));
+    }
+    ids = slotNumbers_.data();
+  }
+  const CatalogColumns columns{catalog_.x(), catalog_.y(), catalog_.z(), catalog_.mag(), ids};
+  timer.lap(sample, FrameStage::Transform);
 
-    out.x = screenX;
-    out.y = screenY;
+  // Only tiles overlapping both the cone around the screen and the sky above
+  // the horizon are projected. Both cones are widened by the largest lift
+  // refraction can apply.
+  const double margin = kCullMarginRad * std::max(1.0, refraction_.factor());
+  const double viewRadius = projection.focalLength > 0.0
+                                ? std::atan(std::hypot(projection.halfWidth, projection.halfHeight) /
+                                            projection.focalLength) +
+                                      margin
+                                : kPi;
+  {
+    trace::Span span("engine", "cull");
+    ranges_.clear();
+    catalog_.collect({equatorialToDevice.row(2), viewRadius},
+                     {equatorialToENU.row(2), kHalfPi + margin},
+                     limitingMag,
+                     ranges_);
+    span.setCount(static_cast<std::int64_t>(ranges_.size()));
+  }
+  timer.lap(sample, FrameStage::Cull);
+
+  // Every other slot is pinned by the reader: drop the frame.
+  float* out = ringBuffer_->writePtr();
+  if (out == nullptr) {
+    return 0;
+  }
+  // The other formats are projected as float records with exact ids (slot
+  // numbers for Vertex) first and encoded into the slot afterwards.
+  if (format != FrameFormat::Float32) {
+    records_.resize(ringBuffer_->capacity() * kStride);
+    out = records_.data();
+    params.rawIds = true;
+  }
+  CullCounters culled;
+  if (timer.enabled()) {
+    params.counters = &culled;
+  }
+  double mergeMicros = 0.0;
+  std::size_t visibleCount = 0;
+  {
+    trace::Span span("engine", "project");
+    visibleCount = projectStars(params, columns, ranges_, out, ringBuffer_->capacity(), mergeMicros);
+    span.setCount(static_cast<std::int64_t>(visibleCount));
+  }
+  timer.lap(sample, FrameStage::Project);
 
-    const std::size_t base = visibleCount * kStride;
-    writePtr[base] = screenX;
-    writePtr[base + 1] = screenY;
-    writePtr[base + 2] = out.mag;
-    writePtr[base + 3] = static_cast<float>(out.hip);
-    visibleCount += 1;
+  if (format != FrameFormat::Float32) {
+    trace::Span span("engine", "encode");
+    const std::array<std::uint8_t*, RingBuffer::kMaxColumns> slotColumns{
+        ringBuffer_->writeColumn(0), ringBuffer_->writeColumn(1), ringBuffer_->writeColumn(2)};
+    if (format == FrameFormat::Vertex) {
+      encodeVertices(out, visibleCount, catalog_.hip(), catalog_.bv(), config_.pointStyle, slotColumns);
+    } else {
+      encodeFrame(format, out, visibleCount, slotColumns);
+    }
   }
+  ringBuffer_->commit(visibleCount, jd);
+  timer.lap(sample, FrameStage::Commit);
+  frameSpan.setCount(static_cast<std::int64_t>(visibleCount));
 
-  ringBuffer_->commit(visibleCount);
+  if (timer.enabled()) {
+    // The merge of worker output runs inside projectStars but belongs to
+    // publishing the frame.
+    const auto merge = static_cast<float>(mergeMicros);
+    sample.stageMicros[static_cast<std::size_t>(FrameStage::Project)] -= merge;
+    sample.stageMicros[static_cast<std::size_t>(FrameStage::Commit)] += merge;
+    std::size_t examined = 0;
+    for (const StarRange& range : ranges_) {
+      examined += range.end - range.begin;
+    }
+    setCounter(sample, FrameCounter::TileCulled, catalog_.size() - examined);
+    setCounter(sample, FrameCounter::Faint, culled.faint);
+    setCounter(sample, FrameCounter::BelowHorizon, culled.belowHorizon);
+    setCounter(sample, FrameCounter::BehindCamera, culled.behindCamera);
+    setCounter(sample, FrameCounter::OffScreen, culled.offScreen);
+    setCounter(sample, FrameCounter::Emitted, visibleCount);
+    stats_.record(sample);
+  }
   return visibleCount;
 }
 
+FrameStats AstroEngine::frameStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_.snapshot();
+}
+
+void AstroEngine::resetFrameStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats_.reset();
+}
+
+std::size_t AstroEngine::projectStars(const ProjectionParams& params,
+                                      const CatalogColumns& columns,
+                                      std::span<const StarRange> ranges,
+                                      float* out,
+                                      std::size_t capacity,
+                                      double& mergeMicros) {
+  const ProjectionKernel kernel = selectProjectionKernel().kernel;
+
+  std::size_t starCount = 0;
+  for (const StarRange& range : ranges) {
+    starCount += range.end - range.begin;
+  }
+
+  const std::size_t slices =
+      workers_ ? std::min(workers_->concurrency(), starCount / kMinStarsPerSlice) : std::size_t{0};
+  if (slices <= 1) {
+    return projectRanges(kernel, params, columns, ranges, 0, starCount, out, capacity);
+  }
+
+  // Slice 0 writes straight into the ring buffer; the others project into
+  // private staging and are appended in slice order afterwards, so the
+  // output matches the serial path exactly.
+  staging_.resize(slices);
+  sliceCounts_.resize(slices);
+  for (std::size_t slice = 1; slice < slices; ++slice) {
+    const std::size_t sliceLength = starCount * (slice + 1) / slices - starCount * slice / slices;
+    staging_[slice].resize(std::min(sliceLength, capacity) * kStride);
+  }
+
+  // Each slice counts its own rejections; they are summed afterwards.
+  CullCounters* const counters = params.counters;
+  if (counters) {
+    sliceCulled_.assign(slices, CullCounters{});
+  }
+
+  auto projectSlice = [&](std::size_t slice) {
+    trace::Span span("worker", "projectSlice");
+    const std::size_t first = starCount * slice / slices;
+    const std::size_t last = starCount * (slice + 1) / slices;
+    float* dst = slice == 0 ? out : staging_[slice].data();
+    ProjectionParams sliceParams = params;
+    if (counters) {
+      sliceParams.counters = &sliceCulled_[slice];
+    }
+    sliceCounts_[slice] =
+        projectRanges(kernel, sliceParams, columns, ranges, first, last, dst, std::min(last - first, capacity));
+    span.setCount(static_cast<std::int64_t>(sliceCounts_[slice]));
+  };
+  workers_->parallelFor(slices, projectSlice);
+
+  using Clock = std::chrono::steady_clock;
+  const Clock::time_point mergeStart = counters ? Clock::now() : Clock::time_point{};
+  std::size_t total = sliceCounts_[0];
+  for (std::size_t slice = 1; slice < slices && total < capacity; ++slice) {
+    const std::size_t count = std::min(sliceCounts_[slice], capacity - total);
+    std::memcpy(out + total * kStride, staging_[slice].data(), count * kStride * sizeof(float));
+    total += count;
+  }
+  if (counters) {
+    for (const CullCounters& culled : sliceCulled_) {
+      addCulled(*counters, culled);
+    }
+    mergeMicros = std::chrono::duration<double, std::micro>(Clock::now() - mergeStart).count();
+  }
+  return total;
+}
+
 }  // namespace astro
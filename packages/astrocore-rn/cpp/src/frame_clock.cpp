@@ -0,0 +1,94 @@
+#include "astro/FrameClock.hpp"
+
+namespace astro {
+
+namespace {
+std::int64_t systemUnixMillis() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+}  // namespace
+
+SteadyFrameClock::SteadyFrameClock(double rateHz)
+    : period_(rateHz > 0.0 ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                 std::chrono::duration<double>(1.0 / rateHz))
+                           : std::chrono::steady_clock::duration::zero()),
+      next_(std::chrono::steady_clock::now() + period_) {}
+
+bool SteadyFrameClock::wait(std::int64_t& unixMs) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  const auto ready = [this] { return stopped_ || woken_; };
+  if (period_ == std::chrono::steady_clock::duration::zero()) {
+    changed_.wait(lock, ready);
+  } else {
+    changed_.wait_until(lock, next_, ready);
+  }
+  if (stopped_) {
+    return false;
+  }
+  woken_ = false;
+
+  // Keep the cadence, but skip ticks missed while a frame overran rather
+  // than bursting to catch up.
+  const auto now = std::chrono::steady_clock::now();
+  if (period_ != std::chrono::steady_clock::duration::zero() && now >= next_) {
+    next_ += period_ * ((now - next_) / period_ + 1);
+  }
+  unixMs = systemUnixMillis();
+  return true;
+}
+
+void SteadyFrameClock::wake() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    woken_ = true;
+  }
+  changed_.notify_one();
+}
+
+void SteadyFrameClock::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  changed_.notify_all();
+}
+
+void ManualFrameClock::tick(std::int64_t unixMs) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    unixMs_ = unixMs;
+    pending_ = true;
+  }
+  changed_.notify_one();
+}
+
+bool ManualFrameClock::wait(std::int64_t& unixMs) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  changed_.wait(lock, [this] { return stopped_ || pending_; });
+  if (stopped_) {
+    return false;
+  }
+  pending_ = false;
+  unixMs = unixMs_;
+  return true;
+}
+
+void ManualFrameClock::wake() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_ = true;
+  }
+  changed_.notify_one();
+}
+
+void ManualFrameClock::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  changed_.notify_all();
+}
+
+}  // namespace astro
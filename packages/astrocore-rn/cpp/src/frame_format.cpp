@@ -0,0 +1,195 @@
+#include "FrameFormat.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+namespace astro {
+
+namespace {
+
+constexpr std::size_t kRecordFloats = 4;
+
+template <typename T>
+void store(std::uint8_t* column, std::size_t index, T value) {
+  std::memcpy(column + index * sizeof(T), &value, sizeof(T));
+}
+
+// Visible stars lie on screen, so coordinates are never negative and
+// rounding is a truncation. Integer clamping keeps the loop vectorizable.
+std::int16_t toFixed(float coordinate) {
+  return static_cast<std::int16_t>(std::min(static_cast<std::int32_t>(coordinate * kFixedSubpixels + 0.5f), 32767));
+}
+
+std::uint8_t toFixedMag(float mag) {
+  return static_cast<std::uint8_t>(std::clamp((mag - kFixedMagOffset) * kFixedMagSteps + 0.5f, 0.0f, 255.0f));
+}
+
+constexpr float kBvMin = -0.4f;
+constexpr float kBvMax = 2.0f;
+constexpr std::size_t kColorSteps = 256;
+constexpr float kColorScale = static_cast<float>(kColorSteps - 1) / (kBvMax - kBvMin);
+constexpr std::uint32_t kWhite = 0x00FFFFFFu;
+
+std::uint32_t channel(double value) {
+  return static_cast<std::uint32_t>(std::clamp(value, 0.0, 255.0) + 0.5);
+}
+
+// Effective temperature after Ballesteros (2012), then the blackbody color
+// after T. Helland's fit to the CIE 1964 tables.
+std::uint32_t blackbodyColor(double bv) {
+  const double kelvin = 4600.0 * (1.0 / (0.92 * bv + 1.7) + 1.0 / (0.92 * bv + 0.62));
+  const double t = kelvin / 100.0;
+  const double red = t <= 66.0 ? 255.0 : 329.698727446 * std::pow(t - 60.0, -0.1332047592);
+  const double green = t <= 66.0 ? 99.4708025861 * std::log(t) - 161.1195681661
+                                 : 288.1221695283 * std::pow(t - 60.0, -0.0755148492);
+  const double blue = t >= 66.0 ? 255.0 : (t <= 19.0 ? 0.0 : 138.5177312231 * std::log(t - 10.0) - 305.0447927307);
+  return channel(red) | channel(green) << 8 | channel(blue) << 16;
+}
+
+const std::array<std::uint32_t, kColorSteps>& colorTable() {
+  static const std::array<std::uint32_t, kColorSteps> table = [] {
+    std::array<std::uint32_t, kColorSteps> colors{};
+    for (std::size_t i = 0; i < kColorSteps; ++i) {
+      colors[i] = blackbodyColor(kBvMin + static_cast<double>(i) / kColorScale);
+    }
+    return colors;
+  }();
+  return table;
+}
+
+std::uint32_t colorOf(const std::array<std::uint32_t, kColorSteps>& table, float bv) {
+  if (std::isnan(bv)) {
+    return kWhite;
+  }
+  return table[static_cast<std::size_t>(std::clamp((bv - kBvMin) * kColorScale + 0.5f, 0.0f, 255.0f))];
+}
+
+std::uint32_t alphaBits(float alpha) {
+  return static_cast<std::uint32_t>(alpha * 255.0f + 0.5f) << 24;
+}
+
+}  // namespace
+
+RingBuffer::Layout frameLayout(FrameFormat format) {
+  const auto tag = static_cast<std::uint32_t>(format);
+  switch (format) {
+    case FrameFormat::Float32:
+      break;
+    case FrameFormat::Fixed16:
+      return {tag, {2 * sizeof(std::int16_t), sizeof(std::uint8_t), sizeof(std::uint32_t)}};
+    case FrameFormat::Half:
+      return {tag, {2 * sizeof(std::uint16_t), sizeof(std::uint16_t), sizeof(std::uint32_t)}};
+    case FrameFormat::Vertex:
+      return {tag, {3 * sizeof(float) + sizeof(std::uint32_t), sizeof(std::uint32_t), 0}};
+  }
+  return {static_cast<std::uint32_t>(FrameFormat::Float32), {kRecordFloats * sizeof(float), 0, 0}};
+}
+
+void encodeFrame(FrameFormat format,
+                 const float* records,
+                 std::size_t count,
+                 const std::array<std::uint8_t*, RingBuffer::kMaxColumns>& columns) {
+  // Locals, so the byte stores below cannot make the compiler reload them.
+  std::uint8_t* const positions = columns[0];
+  std::uint8_t* const mags = columns[1];
+  std::uint8_t* const ids = columns[2];
+  if (format == FrameFormat::Fixed16) {
+    for (std::size_t i = 0; i < count; ++i) {
+      const float* record = records + i * kRecordFloats;
+      store(positions, 2 * i, toFixed(record[0]));
+      store(positions, 2 * i + 1, toFixed(record[1]));
+      store(mags, i, toFixedMag(record[2]));
+    }
+  } else if (format == FrameFormat::Half) {
+    for (std::size_t i = 0; i < count; ++i) {
+      const float* record = records + i * kRecordFloats;
+      store(positions, 2 * i, floatToHalf(record[0]));
+      store(positions, 2 * i + 1, floatToHalf(record[1]));
+      store(mags, i, floatToHalf(record[2]));
+    }
+  } else {
+    return;
+  }
+  for (std::size_t i = 0; i < count; ++i) {
+    store(ids, i, std::bit_cast<std::uint32_t>(records[i * kRecordFloats + 3]));
+  }
+}
+
+void encodeVertices(const float* records,
+                    std::size_t count,
+                    const std::int32_t* hip,
+                    const float* bv,
+                    const PointStyle& style,
+                    const std::array<std::uint8_t*, RingBuffer::kMaxColumns>& columns) {
+  std::uint8_t* const vertices = columns[0];
+  std::uint8_t* const ids = columns[1];
+  const auto& table = colorTable();
+  const auto sizeAtMag0 = static_cast<float>(style.sizeAtMag0);
+  const auto sizePerMag = static_cast<float>(style.sizePerMag);
+  const auto minSize = static_cast<float>(style.minSize);
+  const auto maxSize = std::max(static_cast<float>(style.maxSize), minSize);
+  const auto alphaAtMag0 = static_cast<float>(style.alphaAtMag0);
+  const auto alphaPerMag = static_cast<float>(style.alphaPerMag);
+  const float minAlpha = std::clamp(static_cast<float>(style.minAlpha), 0.0f, 1.0f);
+  for (std::size_t i = 0; i < count; ++i) {
+    const float* record = records + i * kRecordFloats;
+    const float mag = record[2];
+    const auto slot = std::bit_cast<std::uint32_t>(record[3]);
+    const float size = std::clamp(sizeAtMag0 - sizePerMag * mag, minSize, maxSize);
+    const float alpha = std::clamp(alphaAtMag0 - alphaPerMag * mag, minAlpha, 1.0f);
+    const std::uint32_t color = (bv != nullptr ? colorOf(table, bv[slot]) : kWhite) | alphaBits(alpha);
+    store(vertices, 4 * i, record[0]);
+    store(vertices, 4 * i + 1, record[1]);
+    store(vertices, 4 * i + 2, size);
+    store(vertices, 4 * i + 3, color);
+    store(ids, i, static_cast<std::uint32_t>(hip[slot]));
+  }
+}
+
+std::uint32_t starColor(float bv, float alpha) {
+  return colorOf(colorTable(), bv) | alphaBits(std::clamp(alpha, 0.0f, 1.0f));
+}
+
+// After F. Giesen's float_to_half_fast3_rtne.
+std::uint16_t floatToHalf(float value) {
+  constexpr std::uint32_t kInfinity = 255u << 23;
+  constexpr std::uint32_t kHalfOverflow = (127u + 16u) << 23;
+  constexpr std::uint32_t kSmallestNormal = 113u << 23;
+  constexpr std::uint32_t kDenormMagic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+  std::uint32_t bits = std::bit_cast<std::uint32_t>(value);
+  const std::uint32_t sign = bits & 0x80000000u;
+  bits ^= sign;
+  std::uint32_t half = 0;
+  if (bits >= kHalfOverflow) {
+    half = bits > kInfinity ? 0x7E00u : 0x7C00u;
+  } else if (bits < kSmallestNormal) {
+    // Lines the 10 mantissa bits up at the bottom of a float; the addition
+    // rounds them to nearest even.
+    const float aligned = std::bit_cast<float>(bits) + std::bit_cast<float>(kDenormMagic);
+    half = std::bit_cast<std::uint32_t>(aligned) - kDenormMagic;
+  } else {
+    const std::uint32_t odd = (bits >> 13) & 1u;
+    bits += ((15u - 127u) << 23) + 0xFFFu + odd;
+    half = bits >> 13;
+  }
+  return static_cast<std::uint16_t>(half | (sign >> 16));
+}
+
+float halfToFloat(std::uint16_t half) {
+  const std::uint32_t sign = static_cast<std::uint32_t>(half & 0x8000u) << 16;
+  const std::uint32_t exponent = (half >> 10) & 0x1Fu;
+  const std::uint32_t mantissa = half & 0x3FFu;
+  if (exponent == 0) {
+    const float magnitude = std::ldexp(static_cast<float>(mantissa), -24);
+    return sign != 0 ? -magnitude : magnitude;
+  }
+  if (exponent == 0x1F) {
+    return std::bit_cast<float>(sign | 0x7F800000u | (mantissa << 13));
+  }
+  return std::bit_cast<float>(sign | ((exponent + 112u) << 23) | (mantissa << 13));
+}
+
+}  // namespace astro
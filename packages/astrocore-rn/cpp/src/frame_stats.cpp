@@ -0,0 +1,104 @@
+#include "astro/FrameStats.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace astro {
+
+namespace {
+
+// Nearest-rank percentiles of the first `count` values.
+template <typename T>
+Percentiles percentiles(std::array<T, FrameStatsRecorder::kWindow>& values, std::size_t count) {
+  if (count == 0) {
+    return {};
+  }
+  std::sort(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(count));
+  const auto rank = [&](double p) {
+    const auto index = static_cast<std::size_t>(std::ceil(p * static_cast<double>(count)));
+    return static_cast<double>(values[std::clamp<std::size_t>(index, 1, count) - 1]);
+  };
+  return {rank(0.50), rank(0.95), rank(0.99)};
+}
+
+}  // namespace
+
+const char* frameStageName(FrameStage stage) {
+  switch (stage) {
+    case FrameStage::Sidereal:
+      return "sidereal";
+    case FrameStage::Transform:
+      return "transform";
+    case FrameStage::Cull:
+      return "cull";
+    case FrameStage::Project:
+      return "project";
+    case FrameStage::Commit:
+      return "commit";
+    case FrameStage::Total:
+      return "total";
+  }
+  return "unknown";
+}
+
+const char* frameCounterName(FrameCounter counter) {
+  switch (counter) {
+    case FrameCounter::TileCulled:
+      return "tileCulled";
+    case FrameCounter::Faint:
+      return "faint";
+    case FrameCounter::BelowHorizon:
+      return "belowHorizon";
+    case FrameCounter::BehindCamera:
+      return "behindCamera";
+    case FrameCounter::OffScreen:
+      return "offScreen";
+    case FrameCounter::Emitted:
+      return "emitted";
+  }
+  return "unknown";
+}
+
+void FrameStatsRecorder::record(FrameSample sample) {
+  float total = 0.0f;
+  for (std::size_t s = 0; s < kFrameStageCount; ++s) {
+    if (s != static_cast<std::size_t>(FrameStage::Total)) {
+      total += sample.stageMicros[s];
+    }
+  }
+  sample.stageMicros[static_cast<std::size_t>(FrameStage::Total)] = total;
+  samples_[frames_ % kWindow] = sample;
+  ++frames_;
+}
+
+FrameStats FrameStatsRecorder::snapshot() const {
+  FrameStats stats;
+  stats.frames = frames_;
+  stats.window = static_cast<std::size_t>(std::min<std::uint64_t>(frames_, kWindow));
+  if (frames_ == 0) {
+    return stats;
+  }
+  stats.last = samples_[(frames_ - 1) % kWindow];
+
+  std::array<float, kWindow> micros;
+  for (std::size_t s = 0; s < kFrameStageCount; ++s) {
+    for (std::size_t i = 0; i < stats.window; ++i) {
+      micros[i] = samples_[i].stageMicros[s];
+    }
+    stats.stageMicros[s] = percentiles(micros, stats.window);
+  }
+  std::array<std::uint32_t, kWindow> counts;
+  for (std::size_t c = 0; c < kFrameCounterCount; ++c) {
+    for (std::size_t i = 0; i < stats.window; ++i) {
+      counts[i] = samples_[i].counters[c];
+    }
+    stats.counters[c] = percentiles(counts, stats.window);
+  }
+  return stats;
+}
+
+void FrameStatsRecorder::reset() {
+  frames_ = 0;
+}
+
+}  // namespace astro
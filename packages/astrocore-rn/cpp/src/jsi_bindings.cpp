@@ -29,6 +29,18 @@ void install(jsi::Runtime& runtime) {
   runtime.global().setProperty(runtime, "AstroCore", std::move(installerObject));
 }
 
+void uninstall(jsi::Runtime& runtime) {
+  jsi::Object global = runtime.global();
+  const jsi::Value binding = global.getProperty(runtime, "AstroCore");
+  if (binding.isObject()) {
+    const jsi::Object object = binding.getObject(runtime);
+    if (object.isHostObject<AstroCoreHostObject>(runtime)) {
+      object.getHostObject<AstroCoreHostObject>(runtime)->release();
+    }
+  }
+  global.setProperty(runtime, "AstroCore", jsi::Value::undefined());
+}
+
 #if defined(__ANDROID__)
 extern "C" JNIEXPORT void JNICALL
 Java_com_astrocore_AstroCorePackage_nativeInstall(JNIEnv*, jclass, jlong runtimePointer) {
@@ -38,6 +50,14 @@ Java_com_astrocore_AstroCorePackage_nativeInstall(JNIEnv*, jclass, jlong runtime
   auto* runtime = reinterpret_cast<facebook::jsi::Runtime*>(runtimePointer);
   install(*runtime);
 }
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_astrocore_AstroCorePackage_nativeUninstall(JNIEnv*, jclass, jlong runtimePointer) {
+  if (runtimePointer == 0) {
+    return;
+  }
+  uninstall(*reinterpret_cast<facebook::jsi::Runtime*>(runtimePointer));
+}
 #endif
 
 }  // namespace astro::jsi
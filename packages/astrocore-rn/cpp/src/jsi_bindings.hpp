@@ -1,9 +1,23 @@
 #pragma once
 
+#include <functional>
+#include <memory>
+
 #include <jsi/jsi.h>
 
+#include "astro/FrameClock.hpp"
+
 namespace astro::jsi {
 
 void install(facebook::jsi::Runtime& runtime);
+// Releases the JSI values the bindings cache in `runtime` and removes
+// global.AstroCore. Call on the JS thread before the runtime is destroyed.
+void uninstall(facebook::jsi::Runtime& runtime);
+
+// Builds the clock for the native frame loop that startEngine starts when
+// frameRateHz or frameOnPose is set. Platform layers can install a
+// vsync-driven clock here; the default is a SteadyFrameClock.
+using FrameClockFactory = std::function<std::shared_ptr<FrameClock>(double rateHz)>;
+void setFrameClockFactory(FrameClockFactory factory);
 
 }  // namespace astro::jsi
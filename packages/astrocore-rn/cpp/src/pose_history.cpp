@@ -0,0 +1,61 @@
+#include "astro/PoseHistory.hpp"
+
+#include <algorithm>
+
+#include "astro/Quaternion.hpp"
+
+namespace astro {
+
+void PoseHistory::push(double unixMs, const PoseQuat& pose) {
+  if (count_ > 0) {
+    const std::size_t newest = (next_ + kCapacity - 1) % kCapacity;
+    if (unixMs < samples_[newest].unixMs) {
+      return;
+    }
+    if (unixMs == samples_[newest].unixMs) {
+      samples_[newest].pose = pose;
+      return;
+    }
+  }
+  samples_[next_] = {unixMs, pose};
+  next_ = (next_ + 1) % kCapacity;
+  count_ = std::min(count_ + 1, kCapacity);
+}
+
+bool PoseHistory::poseAt(double unixMs, double maxLeadMs, PoseQuat& pose) const {
+  if (count_ == 0) {
+    return false;
+  }
+  const Sample& newest = at(count_ - 1);
+  if (count_ == 1 || unixMs <= at(0).unixMs) {
+    pose = unixMs <= at(0).unixMs ? at(0).pose : newest.pose;
+    return true;
+  }
+
+  // Samples a, b bracketing the time, or the last two when it lies ahead.
+  std::size_t b = count_ - 1;
+  if (unixMs < newest.unixMs) {
+    b = 1;
+    while (at(b).unixMs < unixMs) {
+      ++b;
+    }
+  } else {
+    unixMs = std::min(unixMs, newest.unixMs + std::max(maxLeadMs, 0.0));
+  }
+  const Sample& before = at(b - 1);
+  const Sample& after = at(b);
+  const double t = (unixMs - before.unixMs) / (after.unixMs - before.unixMs);
+  pose = Quaternion::slerp(Quaternion::fromPose(before.pose), Quaternion::fromPose(after.pose), t).toPose();
+  return true;
+}
+
+void PoseHistory::clear() {
+  next_ = 0;
+  count_ = 0;
+}
+
+const PoseHistory::Sample& PoseHistory::at(std::size_t i) const {
+  return samples_[(next_ + kCapacity - count_ + i) % kCapacity];
+}
+
+}  // namespace astro
@@ -0,0 +1,147 @@
+#include "ProjectionKernel.hpp"
+
+#include <bit>
+
+namespace astro {
+
+namespace {
+constexpr std::size_t kRecordFloats = 4;
+}  // namespace
+
+std::size_t projectStarsScalar(const ProjectionParams& params,
+                               const CatalogColumns& stars,
+                               std::size_t begin,
+                               std::size_t end,
+                               float* out,
+                               std::size_t capacity) {
+  CullCounters* const counters = cullCounters(params);
+  std::size_t count = 0;
+
+  for (std::size_t i = begin; i < end && count < capacity; ++i) {
+    if (params.filterMagnitude && stars.mag[i] > params.limitingMag) {
+      if (counters) {
+        ++counters->faint;
+      }
+      continue;
+    }
+
+    const float sx = stars.x[i];
+    const float sy = stars.y[i];
+    const float sz = stars.z[i];
+
+    const float up = params.zenith[0] * sx + params.zenith[1] * sy + params.zenith[2] * sz;
+    float scale = 1.0f;
+    float shiftedUp = up;
+    if (params.refraction) {
+      refractLanes(*params.refraction, &up, &scale, &shiftedUp, 1);
+    }
+    if (!(shiftedUp > 0.0f)) {
+      if (counters) {
+        ++counters->belowHorizon;
+      }
+      continue;
+    }
+
+    float dx = params.toDevice[0][0] * sx + params.toDevice[0][1] * sy + params.toDevice[0][2] * sz;
+    float dy = params.toDevice[1][0] * sx + params.toDevice[1][1] * sy + params.toDevice[1][2] * sz;
+    float dz = params.toDevice[2][0] * sx + params.toDevice[2][1] * sy + params.toDevice[2][2] * sz;
+
+    // Refraction only lifts the star towards the zenith, so it can be applied
+    // in device space as a scale plus an offset along the device-frame up axis.
+    if (params.refraction) {
+      const float offset = shiftedUp - scale * up;
+      dx = dx * scale + params.deviceUp[0] * offset;
+      dy = dy * scale + params.deviceUp[1] * offset;
+      dz = dz * scale + params.deviceUp[2] * offset;
+    }
+
+    if (!(dz > 0.0f)) {
+      if (counters) {
+        ++counters->behindCamera;
+      }
+      continue;
+    }
+
+    const float screenX = params.halfWidth + (dx / dz) * params.focalLength;
+    const float screenY = params.halfHeight - (dy / dz) * params.focalLength;
+    if (!(screenX >= 0.0f && screenX <= params.width && screenY >= 0.0f && screenY <= params.height)) {
+      if (counters) {
+        ++counters->offScreen;
+      }
+      continue;
+    }
+
+    float* record = out + count * kRecordFloats;
+    record[0] = screenX;
+    record[1] = screenY;
+    record[2] = stars.mag[i];
+    record[3] = params.rawIds ? std::bit_cast<float>(stars.hip[i]) : static_cast<float>(stars.hip[i]);
+    count += 1;
+  }
+
+  return count;
+}
+
+namespace {
+
+bool alwaysSupported() {
+  return true;
+}
+
+#if defined(ASTRO_HAVE_X86_KERNELS)
+bool cpuHasSse41() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("sse4.1");
+}
+
+bool cpuHasAvx2() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+}
+
+bool cpuHasAvx512() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx512f");
+}
+#endif
+
+// Ordered slowest to fastest; the scalar entry is always usable.
+constexpr ProjectionKernelInfo kKernels[] = {
+    {"scalar", 1, projectStarsScalar, alwaysSupported},
+#if defined(ASTRO_HAVE_X86_KERNELS)
+    {"sse4.1", 4, projectStarsSse41, cpuHasSse41},
+    {"avx2", 8, projectStarsAvx2, cpuHasAvx2},
+    {"avx512", 16, projectStarsAvx512, cpuHasAvx512},
+#endif
+#if defined(ASTRO_HAVE_NEON_KERNELS)
+    // Advanced SIMD is mandatory on AArch64, so no runtime probe is needed.
+    {"neon", 4, projectStarsNeon, alwaysSupported},
+#endif
+};
+
+}  // namespace
+
+std::size_t availableProjectionKernels(const ProjectionKernelInfo** out, std::size_t maxCount) {
+  std::size_t count = 0;
+  for (const ProjectionKernelInfo& info : kKernels) {
+    if (count == maxCount) {
+      break;
+    }
+    if (info.supported()) {
+      out[count++] = &info;
+    }
+  }
+  return count;
+}
+
+const ProjectionKernelInfo& selectProjectionKernel() {
+  static const ProjectionKernelInfo& selected = []() -> const ProjectionKernelInfo& {
+    constexpr std::size_t kMaxKernels = sizeof(kKernels) / sizeof(kKernels[0]);
+    const ProjectionKernelInfo* kernels[kMaxKernels];
+    const std::size_t count = availableProjectionKernels(kernels, kMaxKernels);
+    return *kernels[count - 1];
+  }();
+  return selected;
+}
+
+}  // namespace astro
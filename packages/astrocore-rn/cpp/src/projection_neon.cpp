@@ -0,0 +1,149 @@
+#include "ProjectionKernel.hpp"
+
+#if defined(ASTRO_HAVE_NEON_KERNELS)
+
+#include <arm_neon.h>
+
+namespace astro {
+
+namespace {
+constexpr std::size_t kRecordFloats = 4;
+
+// Lanes set in an all-ones/all-zeros comparison mask.
+inline std::size_t countLanes(uint32x4_t mask) {
+  return vaddvq_u32(vshrq_n_u32(mask, 31));
+}
+}  // namespace
+
+std::size_t projectStarsNeon(const ProjectionParams& params,
+                             const CatalogColumns& stars,
+                             std::size_t begin,
+                             std::size_t end,
+                             float* out,
+                             std::size_t capacity) {
+  constexpr std::size_t kLanes = 4;
+
+  const float32x4_t zero = vdupq_n_f32(0.0f);
+  const float32x4_t one = vdupq_n_f32(1.0f);
+  const float32x4_t z0 = vdupq_n_f32(params.zenith[0]);
+  const float32x4_t z1 = vdupq_n_f32(params.zenith[1]);
+  const float32x4_t z2 = vdupq_n_f32(params.zenith[2]);
+  const float32x4_t m00 = vdupq_n_f32(params.toDevice[0][0]);
+  const float32x4_t m01 = vdupq_n_f32(params.toDevice[0][1]);
+  const float32x4_t m02 = vdupq_n_f32(params.toDevice[0][2]);
+  const float32x4_t m10 = vdupq_n_f32(params.toDevice[1][0]);
+  const float32x4_t m11 = vdupq_n_f32(params.toDevice[1][1]);
+  const float32x4_t m12 = vdupq_n_f32(params.toDevice[1][2]);
+  const float32x4_t m20 = vdupq_n_f32(params.toDevice[2][0]);
+  const float32x4_t m21 = vdupq_n_f32(params.toDevice[2][1]);
+  const float32x4_t m22 = vdupq_n_f32(params.toDevice[2][2]);
+  const float32x4_t u0 = vdupq_n_f32(params.deviceUp[0]);
+  const float32x4_t u1 = vdupq_n_f32(params.deviceUp[1]);
+  const float32x4_t u2 = vdupq_n_f32(params.deviceUp[2]);
+  const float32x4_t halfWidth = vdupq_n_f32(params.halfWidth);
+  const float32x4_t halfHeight = vdupq_n_f32(params.halfHeight);
+  const float32x4_t focal = vdupq_n_f32(params.focalLength);
+  const float32x4_t width = vdupq_n_f32(params.width);
+  const float32x4_t height = vdupq_n_f32(params.height);
+  const float32x4_t limitingMag = vdupq_n_f32(params.limitingMag);
+
+  alignas(16) float upLanes[kLanes];
+  alignas(16) float scaleLanes[kLanes];
+  alignas(16) float shiftedLanes[kLanes];
+  CullCounters* const counters = cullCounters(params);
+  CullCounters culled{};
+
+  // Separate multiplies and adds (no vfmaq) keep rounding identical to the
+  // scalar kernel.
+  float* dst = out;
+  std::size_t i = begin;
+  for (; i + kLanes <= end && static_cast<std::size_t>(dst - out) / kRecordFloats + kLanes <= capacity;
+       i += kLanes) {
+    const float32x4_t sx = vld1q_f32(stars.x + i);
+    const float32x4_t sy = vld1q_f32(stars.y + i);
+    const float32x4_t sz = vld1q_f32(stars.z + i);
+
+    const float32x4_t up = vaddq_f32(vaddq_f32(vmulq_f32(z0, sx), vmulq_f32(z1, sy)), vmulq_f32(z2, sz));
+    float32x4_t scale = one;
+    float32x4_t shiftedUp = up;
+    if (params.refraction) {
+      vst1q_f32(upLanes, up);
+      refractLanes(*params.refraction, upLanes, scaleLanes, shiftedLanes, kLanes);
+      scale = vld1q_f32(scaleLanes);
+      shiftedUp = vld1q_f32(shiftedLanes);
+    }
+
+    const uint32x4_t above = vcgtq_f32(shiftedUp, zero);
+    uint32x4_t visible = above;
+    uint32x4_t faint = vdupq_n_u32(0);
+    if (params.filterMagnitude) {
+      faint = vcgtq_f32(vld1q_f32(stars.mag + i), limitingMag);
+      visible = vbicq_u32(visible, faint);
+    }
+    const uint32x4_t candidates = visible;
+    if (counters) {
+      culled.faint += countLanes(faint);
+      culled.belowHorizon += countLanes(vbicq_u32(vmvnq_u32(faint), above));
+    }
+    if (vmaxvq_u32(visible) == 0) {
+      continue;
+    }
+
+    float32x4_t dx = vaddq_f32(vaddq_f32(vmulq_f32(m00, sx), vmulq_f32(m01, sy)), vmulq_f32(m02, sz));
+    float32x4_t dy = vaddq_f32(vaddq_f32(vmulq_f32(m10, sx), vmulq_f32(m11, sy)), vmulq_f32(m12, sz));
+    float32x4_t dz = vaddq_f32(vaddq_f32(vmulq_f32(m20, sx), vmulq_f32(m21, sy)), vmulq_f32(m22, sz));
+    if (params.refraction) {
+      const float32x4_t offset = vsubq_f32(shiftedUp, vmulq_f32(scale, up));
+      dx = vaddq_f32(vmulq_f32(dx, scale), vmulq_f32(u0, offset));
+      dy = vaddq_f32(vmulq_f32(dy, scale), vmulq_f32(u1, offset));
+      dz = vaddq_f32(vmulq_f32(dz, scale), vmulq_f32(u2, offset));
+    }
+    visible = vandq_u32(visible, vcgtq_f32(dz, zero));
+    const uint32x4_t inFront = visible;
+
+    const float32x4_t screenX = vaddq_f32(halfWidth, vmulq_f32(vdivq_f32(dx, dz), focal));
+    const float32x4_t screenY = vsubq_f32(halfHeight, vmulq_f32(vdivq_f32(dy, dz), focal));
+    visible = vandq_u32(visible, vcgeq_f32(screenX, zero));
+    visible = vandq_u32(visible, vcleq_f32(screenX, width));
+    visible = vandq_u32(visible, vcgeq_f32(screenY, zero));
+    visible = vandq_u32(visible, vcleq_f32(screenY, height));
+
+    if (counters) {
+      culled.behindCamera += countLanes(vbicq_u32(candidates, inFront));
+      culled.offScreen += countLanes(vbicq_u32(inFront, visible));
+    }
+    if (vmaxvq_u32(visible) == 0) {
+      continue;
+    }
+
+    const float32x4_t mag = vld1q_f32(stars.mag + i);
+    const int32x4_t hipBits = vld1q_s32(stars.hip + i);
+    const float32x4_t hip = params.rawIds ? vreinterpretq_f32_s32(hipBits) : vcvtq_f32_s32(hipBits);
+
+    // Transpose (x, y, mag, hip) columns into per-star records.
+    const float32x4x2_t xy = vzipq_f32(screenX, screenY);
+    const float32x4x2_t mh = vzipq_f32(mag, hip);
+
+    vst1q_f32(dst, vcombine_f32(vget_low_f32(xy.val[0]), vget_low_f32(mh.val[0])));
+    dst += kRecordFloats * (vgetq_lane_u32(visible, 0) & 1u);
+    vst1q_f32(dst, vcombine_f32(vget_high_f32(xy.val[0]), vget_high_f32(mh.val[0])));
+    dst += kRecordFloats * (vgetq_lane_u32(visible, 1) & 1u);
+    vst1q_f32(dst, vcombine_f32(vget_low_f32(xy.val[1]), vget_low_f32(mh.val[1])));
+    dst += kRecordFloats * (vgetq_lane_u32(visible, 2) & 1u);
+    vst1q_f32(dst, vcombine_f32(vget_high_f32(xy.val[1]), vget_high_f32(mh.val[1])));
+    dst += kRecordFloats * (vgetq_lane_u32(visible, 3) & 1u);
+  }
+
+  if (counters) {
+    addCulled(*counters, culled);
+  }
+  std::size_t count = static_cast<std::size_t>(dst - out) / kRecordFloats;
+  if (i < end && count < capacity) {
+    count += projectStarsScalar(params, stars, i, end, dst, capacity - count);
+  }
+  return count;
+}
+
+}  // namespace astro
+
+#endif  // ASTRO_HAVE_NEON_KERNELS
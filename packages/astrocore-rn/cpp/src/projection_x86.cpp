@@ -0,0 +1,469 @@
+#include "ProjectionKernel.hpp"
+
+#if defined(ASTRO_HAVE_X86_KERNELS)
+
+#include <immintrin.h>
+
+// Each kernel is compiled for its own ISA via target attributes so the rest of
+// the library keeps the baseline flags and the choice happens at runtime.
+#define ASTRO_TARGET(isa) __attribute__((target(isa)))
+
+namespace astro {
+
+namespace {
+constexpr std::size_t kRecordFloats = 4;
+
+// Stores the four interleaved (x, y, mag, hip) records in lane order, advancing
+// the write cursor only past lanes whose bit is set in `mask`.
+ASTRO_TARGET("sse4.1")
+float* storeCompacted4(float* dst, int mask, __m128 r0, __m128 r1, __m128 r2, __m128 r3) {
+  _mm_storeu_ps(dst, r0);
+  dst += kRecordFloats * (mask & 1);
+  _mm_storeu_ps(dst, r1);
+  dst += kRecordFloats * ((mask >> 1) & 1);
+  _mm_storeu_ps(dst, r2);
+  dst += kRecordFloats * ((mask >> 2) & 1);
+  _mm_storeu_ps(dst, r3);
+  dst += kRecordFloats * ((mask >> 3) & 1);
+  return dst;
+}
+}  // namespace
+
+ASTRO_TARGET("sse4.1")
+std::size_t projectStarsSse41(const ProjectionParams& params,
+                              const CatalogColumns& stars,
+                              std::size_t begin,
+                              std::size_t end,
+                              float* out,
+                              std::size_t capacity) {
+  constexpr std::size_t kLanes = 4;
+
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 z0 = _mm_set1_ps(params.zenith[0]);
+  const __m128 z1 = _mm_set1_ps(params.zenith[1]);
+  const __m128 z2 = _mm_set1_ps(params.zenith[2]);
+  const __m128 m00 = _mm_set1_ps(params.toDevice[0][0]);
+  const __m128 m01 = _mm_set1_ps(params.toDevice[0][1]);
+  const __m128 m02 = _mm_set1_ps(params.toDevice[0][2]);
+  const __m128 m10 = _mm_set1_ps(params.toDevice[1][0]);
+  const __m128 m11 = _mm_set1_ps(params.toDevice[1][1]);
+  const __m128 m12 = _mm_set1_ps(params.toDevice[1][2]);
+  const __m128 m20 = _mm_set1_ps(params.toDevice[2][0]);
+  const __m128 m21 = _mm_set1_ps(params.toDevice[2][1]);
+  const __m128 m22 = _mm_set1_ps(params.toDevice[2][2]);
+  const __m128 u0 = _mm_set1_ps(params.deviceUp[0]);
+  const __m128 u1 = _mm_set1_ps(params.deviceUp[1]);
+  const __m128 u2 = _mm_set1_ps(params.deviceUp[2]);
+  const __m128 halfWidth = _mm_set1_ps(params.halfWidth);
+  const __m128 halfHeight = _mm_set1_ps(params.halfHeight);
+  const __m128 focal = _mm_set1_ps(params.focalLength);
+  const __m128 width = _mm_set1_ps(params.width);
+  const __m128 height = _mm_set1_ps(params.height);
+  const __m128 limitingMag = _mm_set1_ps(params.limitingMag);
+
+  alignas(16) float upLanes[kLanes];
+  alignas(16) float scaleLanes[kLanes];
+  alignas(16) float shiftedLanes[kLanes];
+  CullCounters* const counters = cullCounters(params);
+  CullCounters culled{};
+
+  float* dst = out;
+  std::size_t i = begin;
+  for (; i + kLanes <= end && static_cast<std::size_t>(dst - out) / kRecordFloats + kLanes <= capacity;
+       i += kLanes) {
+    const __m128 sx = _mm_loadu_ps(stars.x + i);
+    const __m128 sy = _mm_loadu_ps(stars.y + i);
+    const __m128 sz = _mm_loadu_ps(stars.z + i);
+
+    const __m128 up = _mm_add_ps(_mm_add_ps(_mm_mul_ps(z0, sx), _mm_mul_ps(z1, sy)), _mm_mul_ps(z2, sz));
+    __m128 scale = one;
+    __m128 shiftedUp = up;
+    if (params.refraction) {
+      _mm_store_ps(upLanes, up);
+      refractLanes(*params.refraction, upLanes, scaleLanes, shiftedLanes, kLanes);
+      scale = _mm_load_ps(scaleLanes);
+      shiftedUp = _mm_load_ps(shiftedLanes);
+    }
+
+    const __m128 above = _mm_cmpgt_ps(shiftedUp, zero);
+    __m128 visible = above;
+    int bright = 0xF;
+    if (params.filterMagnitude) {
+      const __m128 magOk = _mm_cmpngt_ps(_mm_loadu_ps(stars.mag + i), limitingMag);
+      visible = _mm_and_ps(visible, magOk);
+      bright = _mm_movemask_ps(magOk);
+    }
+    const int candidates = _mm_movemask_ps(visible);
+    if (counters) {
+      culled.faint += __builtin_popcount(~bright & 0xF);
+      culled.belowHorizon += __builtin_popcount(bright & ~_mm_movemask_ps(above));
+    }
+    if (candidates == 0) {
+      continue;
+    }
+
+    __m128 dx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, sx), _mm_mul_ps(m01, sy)), _mm_mul_ps(m02, sz));
+    __m128 dy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m10, sx), _mm_mul_ps(m11, sy)), _mm_mul_ps(m12, sz));
+    __m128 dz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m20, sx), _mm_mul_ps(m21, sy)), _mm_mul_ps(m22, sz));
+    if (params.refraction) {
+      const __m128 offset = _mm_sub_ps(shiftedUp, _mm_mul_ps(scale, up));
+      dx = _mm_add_ps(_mm_mul_ps(dx, scale), _mm_mul_ps(u0, offset));
+      dy = _mm_add_ps(_mm_mul_ps(dy, scale), _mm_mul_ps(u1, offset));
+      dz = _mm_add_ps(_mm_mul_ps(dz, scale), _mm_mul_ps(u2, offset));
+    }
+    visible = _mm_and_ps(visible, _mm_cmpgt_ps(dz, zero));
+    const int inFront = counters ? _mm_movemask_ps(visible) : 0;
+
+    const __m128 screenX = _mm_add_ps(halfWidth, _mm_mul_ps(_mm_div_ps(dx, dz), focal));
+    const __m128 screenY = _mm_sub_ps(halfHeight, _mm_mul_ps(_mm_div_ps(dy, dz), focal));
+    visible = _mm_and_ps(visible, _mm_cmpge_ps(screenX, zero));
+    visible = _mm_and_ps(visible, _mm_cmple_ps(screenX, width));
+    visible = _mm_and_ps(visible, _mm_cmpge_ps(screenY, zero));
+    visible = _mm_and_ps(visible, _mm_cmple_ps(screenY, height));
+
+    const int mask = _mm_movemask_ps(visible);
+    if (counters) {
+      culled.behindCamera += __builtin_popcount(candidates & ~inFront);
+      culled.offScreen += __builtin_popcount(inFront & ~mask);
+    }
+    if (mask == 0) {
+      continue;
+    }
+
+    const __m128 mag = _mm_loadu_ps(stars.mag + i);
+    const __m128i hipBits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(stars.hip + i));
+    const __m128 hip = params.rawIds ? _mm_castsi128_ps(hipBits) : _mm_cvtepi32_ps(hipBits);
+
+    // 4x4 transpose from (x, y, mag, hip) columns into per-star records.
+    const __m128 xyLo = _mm_unpacklo_ps(screenX, screenY);
+    const __m128 xyHi = _mm_unpackhi_ps(screenX, screenY);
+    const __m128 mhLo = _mm_unpacklo_ps(mag, hip);
+    const __m128 mhHi = _mm_unpackhi_ps(mag, hip);
+    dst = storeCompacted4(dst,
+                          mask,
+                          _mm_shuffle_ps(xyLo, mhLo, 0x44),
+                          _mm_shuffle_ps(xyLo, mhLo, 0xEE),
+                          _mm_shuffle_ps(xyHi, mhHi, 0x44),
+                          _mm_shuffle_ps(xyHi, mhHi, 0xEE));
+  }
+
+  if (counters) {
+    addCulled(*counters, culled);
+  }
+  std::size_t count = static_cast<std::size_t>(dst - out) / kRecordFloats;
+  if (i < end && count < capacity) {
+    count += projectStarsScalar(params, stars, i, end, dst, capacity - count);
+  }
+  return count;
+}
+
+ASTRO_TARGET("avx2")
+std::size_t projectStarsAvx2(const ProjectionParams& params,
+                             const CatalogColumns& stars,
+                             std::size_t begin,
+                             std::size_t end,
+                             float* out,
+                             std::size_t capacity) {
+  constexpr std::size_t kLanes = 8;
+
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256 z0 = _mm256_set1_ps(params.zenith[0]);
+  const __m256 z1 = _mm256_set1_ps(params.zenith[1]);
+  const __m256 z2 = _mm256_set1_ps(params.zenith[2]);
+  const __m256 m00 = _mm256_set1_ps(params.toDevice[0][0]);
+  const __m256 m01 = _mm256_set1_ps(params.toDevice[0][1]);
+  const __m256 m02 = _mm256_set1_ps(params.toDevice[0][2]);
+  const __m256 m10 = _mm256_set1_ps(params.toDevice[1][0]);
+  const __m256 m11 = _mm256_set1_ps(params.toDevice[1][1]);
+  const __m256 m12 = _mm256_set1_ps(params.toDevice[1][2]);
+  const __m256 m20 = _mm256_set1_ps(params.toDevice[2][0]);
+  const __m256 m21 = _mm256_set1_ps(params.toDevice[2][1]);
+  const __m256 m22 = _mm256_set1_ps(params.toDevice[2][2]);
+  const __m256 u0 = _mm256_set1_ps(params.deviceUp[0]);
+  const __m256 u1 = _mm256_set1_ps(params.deviceUp[1]);
+  const __m256 u2 = _mm256_set1_ps(params.deviceUp[2]);
+  const __m256 halfWidth = _mm256_set1_ps(params.halfWidth);
+  const __m256 halfHeight = _mm256_set1_ps(params.halfHeight);
+  const __m256 focal = _mm256_set1_ps(params.focalLength);
+  const __m256 width = _mm256_set1_ps(params.width);
+  const __m256 height = _mm256_set1_ps(params.height);
+  const __m256 limitingMag = _mm256_set1_ps(params.limitingMag);
+
+  alignas(32) float upLanes[kLanes];
+  alignas(32) float scaleLanes[kLanes];
+  alignas(32) float shiftedLanes[kLanes];
+  CullCounters* const counters = cullCounters(params);
+  CullCounters culled{};
+
+  float* dst = out;
+  std::size_t i = begin;
+  for (; i + kLanes <= end && static_cast<std::size_t>(dst - out) / kRecordFloats + kLanes <= capacity;
+       i += kLanes) {
+    const __m256 sx = _mm256_loadu_ps(stars.x + i);
+    const __m256 sy = _mm256_loadu_ps(stars.y + i);
+    const __m256 sz = _mm256_loadu_ps(stars.z + i);
+
+    const __m256 up =
+        _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(z0, sx), _mm256_mul_ps(z1, sy)), _mm256_mul_ps(z2, sz));
+    __m256 scale = one;
+    __m256 shiftedUp = up;
+    if (params.refraction) {
+      _mm256_store_ps(upLanes, up);
+      refractLanes(*params.refraction, upLanes, scaleLanes, shiftedLanes, kLanes);
+      scale = _mm256_load_ps(scaleLanes);
+      shiftedUp = _mm256_load_ps(shiftedLanes);
+    }
+
+    const __m256 above = _mm256_cmp_ps(shiftedUp, zero, _CMP_GT_OQ);
+    __m256 visible = above;
+    int bright = 0xFF;
+    if (params.filterMagnitude) {
+      const __m256 mag = _mm256_loadu_ps(stars.mag + i);
+      const __m256 magOk = _mm256_cmp_ps(mag, limitingMag, _CMP_NGT_UQ);
+      visible = _mm256_and_ps(visible, magOk);
+      bright = _mm256_movemask_ps(magOk);
+    }
+    const int candidates = _mm256_movemask_ps(visible);
+    if (counters) {
+      culled.faint += __builtin_popcount(~bright & 0xFF);
+      culled.belowHorizon += __builtin_popcount(bright & ~_mm256_movemask_ps(above));
+    }
+    if (candidates == 0) {
+      continue;
+    }
+
+    __m256 dx =
+        _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m00, sx), _mm256_mul_ps(m01, sy)), _mm256_mul_ps(m02, sz));
+    __m256 dy =
+        _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m10, sx), _mm256_mul_ps(m11, sy)), _mm256_mul_ps(m12, sz));
+    __m256 dz =
+        _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m20, sx), _mm256_mul_ps(m21, sy)), _mm256_mul_ps(m22, sz));
+    if (params.refraction) {
+      const __m256 offset = _mm256_sub_ps(shiftedUp, _mm256_mul_ps(scale, up));
+      dx = _mm256_add_ps(_mm256_mul_ps(dx, scale), _mm256_mul_ps(u0, offset));
+      dy = _mm256_add_ps(_mm256_mul_ps(dy, scale), _mm256_mul_ps(u1, offset));
+      dz = _mm256_add_ps(_mm256_mul_ps(dz, scale), _mm256_mul_ps(u2, offset));
+    }
+    visible = _mm256_and_ps(visible, _mm256_cmp_ps(dz, zero, _CMP_GT_OQ));
+    const int inFront = counters ? _mm256_movemask_ps(visible) : 0;
+
+    const __m256 screenX = _mm256_add_ps(halfWidth, _mm256_mul_ps(_mm256_div_ps(dx, dz), focal));
+    const __m256 screenY = _mm256_sub_ps(halfHeight, _mm256_mul_ps(_mm256_div_ps(dy, dz), focal));
+    visible = _mm256_and_ps(visible, _mm256_cmp_ps(screenX, zero, _CMP_GE_OQ));
+    visible = _mm256_and_ps(visible, _mm256_cmp_ps(screenX, width, _CMP_LE_OQ));
+    visible = _mm256_and_ps(visible, _mm256_cmp_ps(screenY, zero, _CMP_GE_OQ));
+    visible = _mm256_and_ps(visible, _mm256_cmp_ps(screenY, height, _CMP_LE_OQ));
+
+    const int mask = _mm256_movemask_ps(visible);
+    if (counters) {
+      culled.behindCamera += __builtin_popcount(candidates & ~inFront);
+      culled.offScreen += __builtin_popcount(inFront & ~mask);
+    }
+    if (mask == 0) {
+      continue;
+    }
+
+    const __m256 mag = _mm256_loadu_ps(stars.mag + i);
+    const __m256i hipBits = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(stars.hip + i));
+    const __m256 hip = params.rawIds ? _mm256_castsi256_ps(hipBits) : _mm256_cvtepi32_ps(hipBits);
+
+    // In-lane 4x4 transposes: the low 128 bits hold stars 0-3, the high 4-7.
+    const __m256 xyLo = _mm256_unpacklo_ps(screenX, screenY);
+    const __m256 xyHi = _mm256_unpackhi_ps(screenX, screenY);
+    const __m256 mhLo = _mm256_unpacklo_ps(mag, hip);
+    const __m256 mhHi = _mm256_unpackhi_ps(mag, hip);
+    const __m256 r04 = _mm256_shuffle_ps(xyLo, mhLo, 0x44);
+    const __m256 r15 = _mm256_shuffle_ps(xyLo, mhLo, 0xEE);
+    const __m256 r26 = _mm256_shuffle_ps(xyHi, mhHi, 0x44);
+    const __m256 r37 = _mm256_shuffle_ps(xyHi, mhHi, 0xEE);
+
+    dst = storeCompacted4(dst,
+                          mask & 0xF,
+                          _mm256_castps256_ps128(r04),
+                          _mm256_castps256_ps128(r15),
+                          _mm256_castps256_ps128(r26),
+                          _mm256_castps256_ps128(r37));
+    dst = storeCompacted4(dst,
+                          mask >> 4,
+                          _mm256_extractf128_ps(r04, 1),
+                          _mm256_extractf128_ps(r15, 1),
+                          _mm256_extractf128_ps(r26, 1),
+                          _mm256_extractf128_ps(r37, 1));
+  }
+
+  if (counters) {
+    addCulled(*counters, culled);
+  }
+  std::size_t count = static_cast<std::size_t>(dst - out) / kRecordFloats;
+  if (i < end && count < capacity) {
+    count += projectStarsScalar(params, stars, i, end, dst, capacity - count);
+  }
+  return count;
+}
+
+// GCC 12's AVX-512 headers hand _mm512_undefined_ps() to masked builtins and
+// trip -Wmaybe-uninitialized when inlined (GCC bug 105593).
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+ASTRO_TARGET("avx512f")
+std::size_t projectStarsAvx512(const ProjectionParams& params,
+                               const CatalogColumns& stars,
+                               std::size_t begin,
+                               std::size_t end,
+                               float* out,
+                               std::size_t capacity) {
+  constexpr std::size_t kLanes = 16;
+
+  const __m512 zero = _mm512_setzero_ps();
+  const __m512 one = _mm512_set1_ps(1.0f);
+  const __m512 z0 = _mm512_set1_ps(params.zenith[0]);
+  const __m512 z1 = _mm512_set1_ps(params.zenith[1]);
+  const __m512 z2 = _mm512_set1_ps(params.zenith[2]);
+  const __m512 m00 = _mm512_set1_ps(params.toDevice[0][0]);
+  const __m512 m01 = _mm512_set1_ps(params.toDevice[0][1]);
+  const __m512 m02 = _mm512_set1_ps(params.toDevice[0][2]);
+  const __m512 m10 = _mm512_set1_ps(params.toDevice[1][0]);
+  const __m512 m11 = _mm512_set1_ps(params.toDevice[1][1]);
+  const __m512 m12 = _mm512_set1_ps(params.toDevice[1][2]);
+  const __m512 m20 = _mm512_set1_ps(params.toDevice[2][0]);
+  const __m512 m21 = _mm512_set1_ps(params.toDevice[2][1]);
+  const __m512 m22 = _mm512_set1_ps(params.toDevice[2][2]);
+  const __m512 u0 = _mm512_set1_ps(params.deviceUp[0]);
+  const __m512 u1 = _mm512_set1_ps(params.deviceUp[1]);
+  const __m512 u2 = _mm512_set1_ps(params.deviceUp[2]);
+  const __m512 halfWidth = _mm512_set1_ps(params.halfWidth);
+  const __m512 halfHeight = _mm512_set1_ps(params.halfHeight);
+  const __m512 focal = _mm512_set1_ps(params.focalLength);
+  const __m512 width = _mm512_set1_ps(params.width);
+  const __m512 height = _mm512_set1_ps(params.height);
+  const __m512 limitingMag = _mm512_set1_ps(params.limitingMag);
+
+  alignas(64) float upLanes[kLanes];
+  alignas(64) float scaleLanes[kLanes];
+  alignas(64) float shiftedLanes[kLanes];
+  CullCounters* const counters = cullCounters(params);
+  CullCounters culled{};
+
+  float* dst = out;
+  std::size_t i = begin;
+  for (; i + kLanes <= end && static_cast<std::size_t>(dst - out) / kRecordFloats + kLanes <= capacity;
+       i += kLanes) {
+    const __m512 sx = _mm512_loadu_ps(stars.x + i);
+    const __m512 sy = _mm512_loadu_ps(stars.y + i);
+    const __m512 sz = _mm512_loadu_ps(stars.z + i);
+
+    const __m512 up =
+        _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(z0, sx), _mm512_mul_ps(z1, sy)), _mm512_mul_ps(z2, sz));
+    __m512 scale = one;
+    __m512 shiftedUp = up;
+    if (params.refraction) {
+      _mm512_store_ps(upLanes, up);
+      refractLanes(*params.refraction, upLanes, scaleLanes, shiftedLanes, kLanes);
+      scale = _mm512_load_ps(scaleLanes);
+      shiftedUp = _mm512_load_ps(shiftedLanes);
+    }
+
+    // Comparisons yield lane bitmasks directly, so no movemask is needed.
+    const int above = _mm512_cmp_ps_mask(shiftedUp, zero, _CMP_GT_OQ);
+    int bright = 0xFFFF;
+    if (params.filterMagnitude) {
+      bright = _mm512_cmp_ps_mask(_mm512_loadu_ps(stars.mag + i), limitingMag, _CMP_NGT_UQ);
+    }
+    const int candidates = above & bright;
+    if (counters) {
+      culled.faint += __builtin_popcount(~bright & 0xFFFF);
+      culled.belowHorizon += __builtin_popcount(bright & ~above);
+    }
+    if (candidates == 0) {
+      continue;
+    }
+
+    __m512 dx =
+        _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(m00, sx), _mm512_mul_ps(m01, sy)), _mm512_mul_ps(m02, sz));
+    __m512 dy =
+        _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(m10, sx), _mm512_mul_ps(m11, sy)), _mm512_mul_ps(m12, sz));
+    __m512 dz =
+        _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(m20, sx), _mm512_mul_ps(m21, sy)), _mm512_mul_ps(m22, sz));
+    if (params.refraction) {
+      const __m512 offset = _mm512_sub_ps(shiftedUp, _mm512_mul_ps(scale, up));
+      dx = _mm512_add_ps(_mm512_mul_ps(dx, scale), _mm512_mul_ps(u0, offset));
+      dy = _mm512_add_ps(_mm512_mul_ps(dy, scale), _mm512_mul_ps(u1, offset));
+      dz = _mm512_add_ps(_mm512_mul_ps(dz, scale), _mm512_mul_ps(u2, offset));
+    }
+    const int inFront = candidates & _mm512_cmp_ps_mask(dz, zero, _CMP_GT_OQ);
+
+    const __m512 screenX = _mm512_add_ps(halfWidth, _mm512_mul_ps(_mm512_div_ps(dx, dz), focal));
+    const __m512 screenY = _mm512_sub_ps(halfHeight, _mm512_mul_ps(_mm512_div_ps(dy, dz), focal));
+    const int mask = inFront & _mm512_cmp_ps_mask(screenX, zero, _CMP_GE_OQ) &
+                     _mm512_cmp_ps_mask(screenX, width, _CMP_LE_OQ) &
+                     _mm512_cmp_ps_mask(screenY, zero, _CMP_GE_OQ) &
+                     _mm512_cmp_ps_mask(screenY, height, _CMP_LE_OQ);
+    if (counters) {
+      culled.behindCamera += __builtin_popcount(candidates & ~inFront);
+      culled.offScreen += __builtin_popcount(inFront & ~mask);
+    }
+    if (mask == 0) {
+      continue;
+    }
+
+    const __m512 mag = _mm512_loadu_ps(stars.mag + i);
+    const __m512i hipBits = _mm512_loadu_si512(stars.hip + i);
+    const __m512 hip = params.rawIds ? _mm512_castsi512_ps(hipBits) : _mm512_cvtepi32_ps(hipBits);
+
+    // In-lane 4x4 transposes: 128-bit lane k holds stars 4k to 4k + 3.
+    const __m512 xyLo = _mm512_unpacklo_ps(screenX, screenY);
+    const __m512 xyHi = _mm512_unpackhi_ps(screenX, screenY);
+    const __m512 mhLo = _mm512_unpacklo_ps(mag, hip);
+    const __m512 mhHi = _mm512_unpackhi_ps(mag, hip);
+    const __m512 r0 = _mm512_shuffle_ps(xyLo, mhLo, 0x44);
+    const __m512 r1 = _mm512_shuffle_ps(xyLo, mhLo, 0xEE);
+    const __m512 r2 = _mm512_shuffle_ps(xyHi, mhHi, 0x44);
+    const __m512 r3 = _mm512_shuffle_ps(xyHi, mhHi, 0xEE);
+
+    dst = storeCompacted4(dst,
+                          mask & 0xF,
+                          _mm512_extractf32x4_ps(r0, 0),
+                          _mm512_extractf32x4_ps(r1, 0),
+                          _mm512_extractf32x4_ps(r2, 0),
+                          _mm512_extractf32x4_ps(r3, 0));
+    dst = storeCompacted4(dst,
+                          (mask >> 4) & 0xF,
+                          _mm512_extractf32x4_ps(r0, 1),
+                          _mm512_extractf32x4_ps(r1, 1),
+                          _mm512_extractf32x4_ps(r2, 1),
+                          _mm512_extractf32x4_ps(r3, 1));
+    dst = storeCompacted4(dst,
+                          (mask >> 8) & 0xF,
+                          _mm512_extractf32x4_ps(r0, 2),
+                          _mm512_extractf32x4_ps(r1, 2),
+                          _mm512_extractf32x4_ps(r2, 2),
+                          _mm512_extractf32x4_ps(r3, 2));
+    dst = storeCompacted4(dst,
+                          mask >> 12,
+                          _mm512_extractf32x4_ps(r0, 3),
+                          _mm512_extractf32x4_ps(r1, 3),
+                          _mm512_extractf32x4_ps(r2, 3),
+                          _mm512_extractf32x4_ps(r3, 3));
+  }
+
+  if (counters) {
+    addCulled(*counters, culled);
+  }
+  std::size_t count = static_cast<std::size_t>(dst - out) / kRecordFloats;
+  if (i < end && count < capacity) {
+    count += projectStarsScalar(params, stars, i, end, dst, capacity - count);
+  }
+  return count;
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+}  // namespace astro
+
+#endif  // ASTRO_HAVE_X86_KERNELS
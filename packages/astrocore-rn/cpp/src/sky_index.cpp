@@ -0,0 +1,307 @@
+#include "astro/sky_index.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace astro {
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+
+std::uint32_t spreadBits(std::uint32_t v) {
+  v &= 0x0000FFFFu;
+  v = (v | (v << 8)) & 0x00FF00FFu;
+  v = (v | (v << 4)) & 0x0F0F0F0Fu;
+  v = (v | (v << 2)) & 0x33333333u;
+  v = (v | (v << 1)) & 0x55555555u;
+  return v;
+}
+
+std::uint32_t morton(std::uint32_t ix, std::uint32_t iy) {
+  return spreadBits(ix) | (spreadBits(iy) << 1);
+}
+
+// Direction through face coordinates (u, v) in [-1, 1]; the inverse of the
+// face selection in SkyIndex::leafOf.
+Vec3 faceDirection(std::uint32_t face, double u, double v) {
+  switch (face) {
+    case 0:
+      return normalize({1.0, u, v});
+    case 1:
+      return normalize({-1.0, u, v});
+    case 2:
+      return normalize({u, 1.0, v});
+    case 3:
+      return normalize({u, -1.0, v});
+    case 4:
+      return normalize({u, v, 1.0});
+    default:
+      return normalize({u, v, -1.0});
+  }
+}
+
+double angleBetween(const Vec3& a, const Vec3& b) {
+  return std::acos(std::clamp(dot(a, b), -1.0, 1.0));
+}
+
+// Cone with its trigonometry hoisted out of the per-tile tests.
+struct ConeBounds {
+  Vec3 axis;
+  double radius;
+  double cosRadius;
+  double sinRadius;
+
+  explicit ConeBounds(const SkyCone& cone)
+      : axis(cone.axis),
+        radius(cone.radiusRad),
+        cosRadius(std::cos(cone.radiusRad)),
+        sinRadius(std::sin(cone.radiusRad)) {}
+
+  // Angle between the axes is at most the sum of the radii.
+  bool intersects(const SkyTile& tile, double axisDot) const {
+    if (radius + tile.radiusRad >= kPi) {
+      return true;
+    }
+    return axisDot >= cosRadius * tile.cosRadius - sinRadius * tile.sinRadius;
+  }
+
+  // The whole tile lies inside this cone.
+  bool contains(const SkyTile& tile, double axisDot) const {
+    if (tile.radiusRad > radius) {
+      return false;
+    }
+    return axisDot >= cosRadius * tile.cosRadius + sinRadius * tile.sinRadius;
+  }
+};
+
+double axisDot(const SkyTile& tile, const Vec3& v) {
+  return tile.axis[0] * v.x + tile.axis[1] * v.y + tile.axis[2] * v.z;
+}
+
+void appendRange(std::vector<StarRange>& out, std::uint32_t begin, std::uint32_t end) {
+  if (begin == end) {
+    return;
+  }
+  if (!out.empty() && out.back().end == begin) {
+    out.back().end = end;
+    return;
+  }
+  out.push_back({begin, end});
+}
+
+}  // namespace
+
+std::uint32_t SkyIndex::leafOf(int levels, float x, float y, float z) {
+  const float ax = std::fabs(x);
+  const float ay = std::fabs(y);
+  const float az = std::fabs(z);
+
+  std::uint32_t face = 0;
+  float u = 0.0f;
+  float v = 0.0f;
+  if (!(ax > 0.0f || ay > 0.0f || az > 0.0f)) {
+    // Degenerate direction: park it in the first cell of face 0.
+  } else if (ax >= ay && ax >= az) {
+    face = x > 0.0f ? 0 : 1;
+    u = y / ax;
+    v = z / ax;
+  } else if (ay >= az) {
+    face = y > 0.0f ? 2 : 3;
+    u = x / ay;
+    v = z / ay;
+  } else {
+    face = z > 0.0f ? 4 : 5;
+    u = x / az;
+    v = y / az;
+  }
+
+  const std::uint32_t cells = 1u << levels;
+  const auto cell = [cells](float t) {
+    const auto i = static_cast<std::int64_t>((t + 1.0f) * 0.5f * static_cast<float>(cells));
+    return static_cast<std::uint32_t>(std::clamp<std::int64_t>(i, 0, cells - 1));
+  };
+  return (face << (2 * levels)) | morton(cell(u), cell(v));
+}
+
+void SkyIndex::build(int levels,
+                     std::span<const std::uint32_t> leafBegin,
+                     const float* x,
+                     const float* y,
+                     const float* z,
+                     const float* mag) {
+  levels_ = levels;
+  tiles_.assign(levelOffset(levels + 1), SkyTile{});
+
+  for (int l = levels; l >= 0; --l) {
+    const std::uint32_t cells = 1u << l;
+    const std::size_t leavesPerNode = std::size_t{1} << (2 * (levels - l));
+    SkyTile* tiles = tiles_.data() + levelOffset(l);
+
+    for (std::uint32_t face = 0; face < 6; ++face) {
+      for (std::uint32_t iy = 0; iy < cells; ++iy) {
+        for (std::uint32_t ix = 0; ix < cells; ++ix) {
+          const std::size_t node = (std::size_t{face} << (2 * l)) | morton(ix, iy);
+          SkyTile& tile = tiles[node];
+
+          const double u = (ix + 0.5) / cells * 2.0 - 1.0;
+          const double v = (iy + 0.5) / cells * 2.0 - 1.0;
+          const Vec3 axis = faceDirection(face, u, v);
+          tile.axis[0] = static_cast<float>(axis.x);
+          tile.axis[1] = static_cast<float>(axis.y);
+          tile.axis[2] = static_cast<float>(axis.z);
+          tile.begin = leafBegin[node * leavesPerNode];
+          tile.end = leafBegin[(node + 1) * leavesPerNode];
+          fit(l, node, x, y, z, mag);
+        }
+      }
+    }
+  }
+}
+
+void SkyIndex::refit(std::span<const std::uint32_t> leaves,
+                     const float* x,
+                     const float* y,
+                     const float* z,
+                     const float* mag) {
+  std::vector<std::size_t> nodes(leaves.begin(), leaves.end());
+  for (int l = levels_; l >= 0; --l) {
+    for (const std::size_t node : nodes) {
+      fit(l, node, x, y, z, mag);
+    }
+    for (std::size_t& node : nodes) {
+      node /= 4;
+    }
+    nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+  }
+}
+
+void SkyIndex::fit(int l, std::size_t node, const float* x, const float* y, const float* z, const float* mag) {
+  SkyTile& tile = tiles_[levelOffset(l) + node];
+  tile.minMag = std::numeric_limits<float>::infinity();
+  tile.maxMag = -std::numeric_limits<float>::infinity();
+
+  // Measure against the float axis the cull test will actually use.
+  const Vec3 tileAxis{tile.axis[0], tile.axis[1], tile.axis[2]};
+  double radius = 0.0;
+  if (l == levels_) {
+    for (std::uint32_t i = tile.begin; i < tile.end; ++i) {
+      radius = std::max(radius, angleBetween(tileAxis, {x[i], y[i], z[i]}));
+      tile.minMag = std::min(tile.minMag, mag[i]);
+      tile.maxMag = std::max(tile.maxMag, mag[i]);
+    }
+  } else {
+    const SkyTile* children = tiles_.data() + levelOffset(l + 1) + node * 4;
+    for (int c = 0; c < 4; ++c) {
+      const SkyTile& child = children[c];
+      if (child.empty()) {
+        continue;
+      }
+      const Vec3 childAxis{child.axis[0], child.axis[1], child.axis[2]};
+      radius = std::max(radius, angleBetween(tileAxis, childAxis) + child.radiusRad);
+      tile.minMag = std::min(tile.minMag, child.minMag);
+      tile.maxMag = std::max(tile.maxMag, child.maxMag);
+    }
+  }
+
+  // Pad for float rounding in the stored axis and star vectors.
+  radius = std::min(radius + 1e-5, kPi);
+  tile.radiusRad = static_cast<float>(radius);
+  tile.cosRadius = static_cast<float>(std::cos(radius));
+  tile.sinRadius = static_cast<float>(std::sin(radius));
+}
+
+bool SkyIndex::assign(int levels, std::span<const SkyTile> tiles, std::size_t starCount) {
+  if (levels < 0 || levels > kMaxLevels || tiles.size() != tileCount(levels)) {
+    return false;
+  }
+  for (int l = 0; l <= levels; ++l) {
+    const auto level = tiles.subspan(levelOffset(l), std::size_t{6} << (2 * l));
+    std::uint32_t expected = 0;
+    for (const SkyTile& tile : level) {
+      if (tile.begin != expected || tile.end < tile.begin) {
+        return false;
+      }
+      expected = tile.end;
+    }
+    if (expected != starCount) {
+      return false;
+    }
+  }
+  levels_ = levels;
+  tiles_.assign(tiles.begin(), tiles.end());
+  return true;
+}
+
+void SkyIndex::clear() {
+  levels_ = 0;
+  tiles_.clear();
+}
+
+std::span<const SkyTile> SkyIndex::level(int l) const {
+  if (tiles_.empty() || l < 0 || l > levels_) {
+    return {};
+  }
+  return std::span<const SkyTile>(tiles_.data() + levelOffset(l), std::size_t{6} << (2 * l));
+}
+
+void SkyIndex::collect(const SkyCone& view,
+                       const SkyCone& horizon,
+                       double limitingMag,
+                       const float* sortedMag,
+                       std::vector<StarRange>& out) const {
+  if (tiles_.empty()) {
+    return;
+  }
+
+  const ConeBounds viewBounds(view);
+  const ConeBounds horizonBounds(horizon);
+  // Magnitudes are stored as float; compare in float so tiles and stars agree.
+  const float limit = static_cast<float>(limitingMag);
+
+  // Depth-first walk in storage order so emitted ranges come out sorted.
+  struct Pending {
+    int level;
+    std::size_t node;
+  };
+  Pending stack[6 + 3 * kMaxLevels];
+  std::size_t depth = 0;
+  for (std::size_t face = 6; face-- > 0;) {
+    stack[depth++] = {0, face};
+  }
+
+  while (depth > 0) {
+    const Pending current = stack[--depth];
+    const SkyTile& tile = tiles_[levelOffset(current.level) + current.node];
+    if (tile.empty() || !(tile.minMag <= limit)) {
+      continue;
+    }
+
+    const double viewDot = axisDot(tile, viewBounds.axis);
+    const double horizonDot = axisDot(tile, horizonBounds.axis);
+    if (!viewBounds.intersects(tile, viewDot) || !horizonBounds.intersects(tile, horizonDot)) {
+      continue;
+    }
+
+    const bool allBrightEnough = tile.maxMag <= limit;
+    if (current.level == levels_) {
+      std::uint32_t end = tile.end;
+      if (sortedMag != nullptr && !allBrightEnough) {
+        end = static_cast<std::uint32_t>(
+            std::upper_bound(sortedMag + tile.begin, sortedMag + tile.end, limit) - sortedMag);
+      }
+      appendRange(out, tile.begin, end);
+      continue;
+    }
+    if (allBrightEnough && viewBounds.contains(tile, viewDot) && horizonBounds.contains(tile, horizonDot)) {
+      appendRange(out, tile.begin, tile.end);
+      continue;
+    }
+
+    for (std::size_t c = 4; c-- > 0;) {
+      stack[depth++] = {current.level + 1, current.node * 4 + c};
+    }
+  }
+}
+
+}  // namespace astro
@@ -0,0 +1,183 @@
+#include "astro/trace.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+
+namespace astro::trace {
+
+namespace {
+
+static_assert((ASTRO_TRACE_EVENTS & (ASTRO_TRACE_EVENTS - 1)) == 0, "ASTRO_TRACE_EVENTS must be a power of two");
+constexpr std::uint64_t kCapacity = ASTRO_TRACE_EVENTS;
+constexpr std::uint64_t kMask = kCapacity - 1;
+constexpr std::size_t kMaxThreads = 64;
+
+// One ring entry. `sequence` is 2 * index + 1 while the entry is being
+// written and 2 * index + 2 once it is complete, so a reader can tell torn or
+// recycled entries from the one it expects.
+struct Event {
+  std::atomic<std::uint64_t> sequence{0};
+  std::atomic<const char*> category{nullptr};
+  std::atomic<const char*> name{nullptr};
+  std::atomic<std::uint64_t> beginNanos{0};
+  std::atomic<std::uint64_t> endNanos{0};
+  std::atomic<std::int64_t> count{-1};
+  std::atomic<std::uint32_t> thread{0};
+};
+
+struct Ring {
+  std::atomic<std::uint64_t> head{0};
+  // First index of the current session.
+  std::atomic<std::uint64_t> first{0};
+  std::unique_ptr<Event[]> events{std::make_unique<Event[]>(kCapacity)};
+};
+
+std::mutex gStartMutex;
+// Allocated by the first start() and kept for the life of the process, so
+// writers never see it go away.
+std::atomic<Ring*> gRing{nullptr};
+
+std::atomic<std::uint32_t> gNextThread{1};
+std::array<std::atomic<const char*>, kMaxThreads> gThreadNames{};
+
+std::uint32_t threadId() {
+  thread_local const std::uint32_t id = gNextThread.fetch_add(1, std::memory_order_relaxed);
+  return id;
+}
+
+// Names and categories are literals in this code base; only quotes and
+// backslashes would need escaping.
+void writeString(std::FILE* file, const char* text) {
+  std::fputc('"', file);
+  for (const char* c = text; *c != '\0'; ++c) {
+    if (*c == '"' || *c == '\\') {
+      std::fputc('\\', file);
+    }
+    std::fputc(*c, file);
+  }
+  std::fputc('"', file);
+}
+
+}  // namespace
+
+void start() {
+  std::lock_guard<std::mutex> lock(gStartMutex);
+  Ring* ring = gRing.load(std::memory_order_relaxed);
+  if (ring == nullptr) {
+    ring = new Ring;
+    gRing.store(ring, std::memory_order_release);
+  }
+  ring->first.store(ring->head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+  detail::recording.store(true, std::memory_order_release);
+}
+
+void stop() {
+  detail::recording.store(false, std::memory_order_release);
+}
+
+void setThreadName(const char* name) {
+  const std::uint32_t id = threadId();
+  if (id < kMaxThreads) {
+    gThreadNames[id].store(name, std::memory_order_relaxed);
+  }
+}
+
+std::uint64_t nowNanos() {
+  return static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+
+void record(const char* category, const char* name, std::uint64_t beginNanos, std::uint64_t endNanos,
+            std::int64_t count) {
+  Ring* ring = gRing.load(std::memory_order_acquire);
+  if (ring == nullptr || !recording()) {
+    return;
+  }
+  const std::uint64_t index = ring->head.fetch_add(1, std::memory_order_relaxed);
+  Event& event = ring->events[index & kMask];
+  // Claim the entry before writing it. A writer that was descheduled for a
+  // whole lap of the ring meets either a newer event or one still being
+  // written, and only one of the two claims succeeds; the other event is
+  // dropped, so no entry ever mixes two events.
+  std::uint64_t observed = event.sequence.load(std::memory_order_relaxed);
+  if (observed > 2 * index || (observed & 1) != 0 ||
+      !event.sequence.compare_exchange_strong(observed, 2 * index + 1, std::memory_order_relaxed)) {
+    return;
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+  event.category.store(category, std::memory_order_relaxed);
+  event.name.store(name, std::memory_order_relaxed);
+  event.beginNanos.store(beginNanos, std::memory_order_relaxed);
+  event.endNanos.store(endNanos, std::memory_order_relaxed);
+  event.count.store(count, std::memory_order_relaxed);
+  event.thread.store(threadId(), std::memory_order_relaxed);
+  event.sequence.store(2 * index + 2, std::memory_order_release);
+}
+
+bool dump(const std::string& path) {
+  std::FILE* file = std::fopen(path.c_str(), "w");
+  if (file == nullptr) {
+    return false;
+  }
+  std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", file);
+  bool firstEvent = true;
+  const auto separate = [&] {
+    std::fputs(firstEvent ? "\n" : ",\n", file);
+    firstEvent = false;
+  };
+
+  for (std::uint32_t id = 1; id < kMaxThreads; ++id) {
+    if (const char* name = gThreadNames[id].load(std::memory_order_relaxed)) {
+      separate();
+      std::fprintf(file, "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", id);
+      writeString(file, name);
+      std::fputs("}}", file);
+    }
+  }
+
+  if (Ring* ring = gRing.load(std::memory_order_acquire)) {
+    const std::uint64_t head = ring->head.load(std::memory_order_acquire);
+    const std::uint64_t first = ring->first.load(std::memory_order_relaxed);
+    const std::uint64_t begin = head - first > kCapacity ? head - kCapacity : first;
+    for (std::uint64_t index = begin; index < head; ++index) {
+      const Event& event = ring->events[index & kMask];
+      const std::uint64_t sequence = event.sequence.load(std::memory_order_acquire);
+      if (sequence != 2 * index + 2) {
+        continue;
+      }
+      const char* category = event.category.load(std::memory_order_relaxed);
+      const char* name = event.name.load(std::memory_order_relaxed);
+      const std::uint64_t beginNanos = event.beginNanos.load(std::memory_order_relaxed);
+      const std::uint64_t endNanos = event.endNanos.load(std::memory_order_relaxed);
+      const std::int64_t count = event.count.load(std::memory_order_relaxed);
+      const std::uint32_t thread = event.thread.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (event.sequence.load(std::memory_order_relaxed) != sequence) {
+        continue;
+      }
+
+      separate();
+      std::fputs("{\"ph\":\"X\",\"cat\":", file);
+      writeString(file, category);
+      std::fputs(",\"name\":", file);
+      writeString(file, name);
+      std::fprintf(file,
+                   ",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f",
+                   thread,
+                   static_cast<double>(beginNanos) * 1e-3,
+                   static_cast<double>(endNanos - beginNanos) * 1e-3);
+      if (count >= 0) {
+        std::fprintf(file, ",\"args\":{\"count\":%lld}", static_cast<long long>(count));
+      }
+      std::fputc('}', file);
+    }
+  }
+  std::fputs("\n]}\n", file);
+  return std::fclose(file) == 0;
+}
+
+}  // namespace astro::trace
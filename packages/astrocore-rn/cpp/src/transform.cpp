@@ -9,6 +9,19 @@ namespace {
 constexpr double kDegToRad = 0.01745329251994329577;
 constexpr double kRadToDeg = 57.2957795130823208768;
 constexpr double kTwoPi = 6.28318530717958647692;
+constexpr double kArcsecToRad = kDegToRad / 3600.0;
+constexpr double kJ2000 = 2451545.0;
+constexpr double kDaysPerCentury = 36525.0;
+// ICRS frame bias (IERS Conventions 2003): the J2000 mean equinox offset and
+// the pole offsets, in arcseconds.
+constexpr double kBiasDeltaAlpha0 = -0.0146;
+constexpr double kBiasXi0 = -0.016617;
+constexpr double kBiasEta0 = -0.006819;
+// Constant of aberration, arcseconds.
+constexpr double kAberrationArcsec = 20.49552;
+// Conditions the Saemundsson formula is calibrated for.
+constexpr double kReferencePressureHPa = 1010.0;
+constexpr double kReferenceTemperatureK = 283.15;
 
 double wrapAzimuth(double az) {
   az = std::fmod(az, kTwoPi);
@@ -38,14 +51,190 @@ Horizontal equatorialToHorizontal(double raDeg, double decDeg, double lstRad, do
   return {alt, az};
 }
 
-double applyRefraction(double altRad) {
+double applyRefraction(double altRad, double factor) {
   const double altDeg = altRad * kRadToDeg;
   if (altDeg < -1.0) {
     return altRad;
   }
 
   const double refrDeg = 1.0 / std::tan((altDeg + 7.31 / (altDeg + 4.4)) * kDegToRad) / 60.0;
-  return altRad + refrDeg * kDegToRad;
+  return altRad + std::max(refrDeg * factor, 0.0) * kDegToRad;
+}
+
+void equatorialToHorizontal(std::span<const double> raDeg,
+                            std::span<const double> decDeg,
+                            double lstRad,
+                            double latDeg,
+                            std::span<double> altRad,
+                            std::span<double> azRad) {
+  const std::size_t n = std::min({raDeg.size(), decDeg.size(), altRad.size(), azRad.size()});
+  const double latRad = latDeg * kDegToRad;
+  const double sinLat = std::sin(latRad);
+  const double cosLat = std::cos(latRad);
+  for (std::size_t i = 0; i < n; ++i) {
+    const double hourAngle = lstRad - raDeg[i] * kDegToRad;
+    const double decRad = decDeg[i] * kDegToRad;
+    const double sinDec = std::sin(decRad);
+    const double cosDec = std::cos(decRad);
+    const double cosHourAngle = std::cos(hourAngle);
+
+    const double sinAlt = sinDec * sinLat + cosDec * cosLat * cosHourAngle;
+    const double y = -std::sin(hourAngle) * cosDec;
+    const double x = sinDec * cosLat - cosDec * sinLat * cosHourAngle;
+    // atan2 stays within [-pi, pi], so one wrap is enough.
+    const double az = std::atan2(y, x);
+    altRad[i] = std::asin(std::clamp(sinAlt, -1.0, 1.0));
+    azRad[i] = az < 0.0 ? az + kTwoPi : az;
+  }
+}
+
+void applyRefraction(std::span<const double> altRad, std::span<double> refractedRad, double factor) {
+  const std::size_t n = std::min(altRad.size(), refractedRad.size());
+  for (std::size_t i = 0; i < n; ++i) {
+    refractedRad[i] = applyRefraction(altRad[i], factor);
+  }
+}
+
+double standardPressureHPa(double elevationM) {
+  return kReferencePressureHPa * std::pow(std::max(1.0 - 2.25577e-5 * elevationM, 0.0), 5.25588);
+}
+
+double refractionFactor(const Observer& observer) {
+  const double pressure =
+      observer.pressureHPa > 0.0 ? observer.pressureHPa : standardPressureHPa(observer.elevationM);
+  return (pressure / kReferencePressureHPa) * (kReferenceTemperatureK / (273.15 + observer.temperatureC));
+}
+
+Mat3 equatorialToENUMatrix(double lstRad, double latDeg) {
+  const double latRad = latDeg * kDegToRad;
+  const double sinLst = std::sin(lstRad);
+  const double cosLst = std::cos(lstRad);
+  const double sinLat = std::sin(latRad);
+  const double cosLat = std::cos(latRad);
+
+  Mat3 out;
+  out.m[0][0] = -sinLst;
+  out.m[0][1] = cosLst;
+  out.m[0][2] = 0.0;
+  out.m[1][0] = -sinLat * cosLst;
+  out.m[1][1] = -sinLat * sinLst;
+  out.m[1][2] = cosLat;
+  out.m[2][0] = cosLat * cosLst;
+  out.m[2][1] = cosLat * sinLst;
+  out.m[2][2] = sinLat;
+  return out;
+}
+
+ApparentFrame apparentFrame(double jd) {
+  const double t = (jd - kJ2000) / kDaysPerCentury;
+
+  // Frame bias to first order; the angles are a few milliarcseconds.
+  const double da = kBiasDeltaAlpha0 * kArcsecToRad;
+  const double xi = kBiasXi0 * kArcsecToRad;
+  const double eta = kBiasEta0 * kArcsecToRad;
+  Mat3 bias;
+  bias.m[0][1] = da;
+  bias.m[0][2] = -xi;
+  bias.m[1][0] = -da;
+  bias.m[1][2] = -eta;
+  bias.m[2][0] = xi;
+  bias.m[2][1] = eta;
+
+  // IAU 1976 precession (Lieske) from J2000 to the mean equinox of date.
+  const double zeta = (2306.2181 + (0.30188 + 0.017998 * t) * t) * t * kArcsecToRad;
+  const double z = (2306.2181 + (1.09468 + 0.018203 * t) * t) * t * kArcsecToRad;
+  const double theta = (2004.3109 - (0.42665 + 0.041833 * t) * t) * t * kArcsecToRad;
+  const double sinZeta = std::sin(zeta);
+  const double cosZeta = std::cos(zeta);
+  const double sinZ = std::sin(z);
+  const double cosZ = std::cos(z);
+  const double sinTheta = std::sin(theta);
+  const double cosTheta = std::cos(theta);
+  Mat3 precession;
+  precession.m[0][0] = cosZeta * cosTheta * cosZ - sinZeta * sinZ;
+  precession.m[0][1] = -sinZeta * cosTheta * cosZ - cosZeta * sinZ;
+  precession.m[0][2] = -sinTheta * cosZ;
+  precession.m[1][0] = cosZeta * cosTheta * sinZ + sinZeta * cosZ;
+  precession.m[1][1] = -sinZeta * cosTheta * sinZ + cosZeta * cosZ;
+  precession.m[1][2] = -sinTheta * sinZ;
+  precession.m[2][0] = cosZeta * sinTheta;
+  precession.m[2][1] = -sinZeta * sinTheta;
+  precession.m[2][2] = cosTheta;
+
+  // Leading nutation terms (Meeus, ch. 22) from the Moon's node and the mean
+  // longitudes of the Sun and the Moon.
+  const double node = (125.04452 - 1934.136261 * t) * kDegToRad;
+  const double sunLon = (280.4665 + 36000.7698 * t) * kDegToRad;
+  const double moonLon = (218.3165 + 481267.8813 * t) * kDegToRad;
+  const double dPsi = (-17.20 * std::sin(node) - 1.32 * std::sin(2.0 * sunLon) - 0.23 * std::sin(2.0 * moonLon) +
+                       0.21 * std::sin(2.0 * node)) *
+                      kArcsecToRad;
+  const double dEps = (9.20 * std::cos(node) + 0.57 * std::cos(2.0 * sunLon) + 0.10 * std::cos(2.0 * moonLon) -
+                       0.09 * std::cos(2.0 * node)) *
+                      kArcsecToRad;
+  const double meanEps = (84381.448 + (-46.8150 + (-0.00059 + 0.001813 * t) * t) * t) * kArcsecToRad;
+  const double trueEps = meanEps + dEps;
+  const double sinPsi = std::sin(dPsi);
+  const double cosPsi = std::cos(dPsi);
+  const double sinMean = std::sin(meanEps);
+  const double cosMean = std::cos(meanEps);
+  const double sinTrue = std::sin(trueEps);
+  const double cosTrue = std::cos(trueEps);
+  Mat3 nutation;
+  nutation.m[0][0] = cosPsi;
+  nutation.m[0][1] = -sinPsi * cosMean;
+  nutation.m[0][2] = -sinPsi * sinMean;
+  nutation.m[1][0] = sinPsi * cosTrue;
+  nutation.m[1][1] = cosPsi * cosTrue * cosMean + sinTrue * sinMean;
+  nutation.m[1][2] = cosPsi * cosTrue * sinMean - sinTrue * cosMean;
+  nutation.m[2][0] = sinPsi * sinTrue;
+  nutation.m[2][1] = cosPsi * sinTrue * cosMean - cosTrue * sinMean;
+  nutation.m[2][2] = cosPsi * sinTrue * sinMean + cosTrue * cosMean;
+
+  // Earth moves towards ecliptic longitude lambda_sun - 90 deg, corrected for
+  // the eccentricity of its orbit (Meeus, ch. 23 and 25).
+  const double meanAnomaly = (357.52911 + (35999.05029 - 0.0001537 * t) * t) * kDegToRad;
+  const double center = (1.914602 - (0.004817 + 0.000014 * t) * t) * std::sin(meanAnomaly) +
+                        (0.019993 - 0.000101 * t) * std::sin(2.0 * meanAnomaly) +
+                        0.000289 * std::sin(3.0 * meanAnomaly);
+  const double trueSunLon = (280.46646 + (36000.76983 + 0.0003032 * t) * t + center) * kDegToRad;
+  const double eccentricity = 0.016708634 - (0.000042037 + 0.0000001267 * t) * t;
+  const double perihelion = (102.93735 + (1.71946 + 0.00046 * t) * t) * kDegToRad;
+  const double kappa = kAberrationArcsec * kArcsecToRad;
+  const double ex = kappa * (std::sin(trueSunLon) - eccentricity * std::sin(perihelion));
+  const double ey = kappa * (eccentricity * std::cos(perihelion) - std::cos(trueSunLon));
+
+  ApparentFrame frame;
+  frame.biasPrecessionNutation = nutation * (precession * bias);
+  frame.aberration = {ex, ey * cosTrue, ey * sinTrue};
+  frame.equationOfEquinoxesRad = dPsi * cosTrue;
+  return frame;
+}
+
+RefractionShift refractionShift(double sinAlt, double factor) {
+  const double altRad = std::asin(std::clamp(sinAlt, -1.0, 1.0));
+  const double refracted = applyRefraction(altRad, factor);
+  const double cosAlt = std::cos(altRad);
+  if (refracted == altRad || cosAlt < 1e-12) {
+    return {1.0, sinAlt};
+  }
+  return {std::cos(refracted) / cosAlt, std::sin(refracted)};
+}
+
+RefractionTable::RefractionTable(double factor) : factor_(factor) {
+  for (std::size_t i = 0; i <= kIntervals; ++i) {
+    const double sinAlt = RefractionGrid::nodeSinAlt(i);
+    const RefractionShift shift = refractionShift(sinAlt, factor);
+    nodes_[i].scale = static_cast<float>(shift.scale - 1.0);
+    nodes_[i].up = static_cast<float>(shift.up - sinAlt);
+  }
+}
+
+RefractionLiftTable::RefractionLiftTable() {
+  for (std::size_t i = 0; i <= RefractionGrid::kIntervals; ++i) {
+    const double altRad = std::asin(std::min(RefractionGrid::nodeSinAlt(i), 1.0));
+    nodes_[i] = static_cast<float>(applyRefraction(altRad) - altRad);
+  }
 }
 
 }  // namespace astro::transform
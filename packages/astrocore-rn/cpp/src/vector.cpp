@@ -1,5 +1,6 @@
 #include "astro/vector.hpp"
 
+#include <algorithm>
 #include <cmath>
 
 namespace astro::vector {
@@ -8,6 +9,13 @@ namespace {
 constexpr double kDegToRad = 0.01745329251994329577;
 }  // namespace
 
+Vec3 equatorialToUnit(double raDeg, double decDeg) {
+  const double raRad = raDeg * kDegToRad;
+  const double decRad = decDeg * kDegToRad;
+  const double cosDec = std::cos(decRad);
+  return {cosDec * std::cos(raRad), cosDec * std::sin(raRad), std::sin(decRad)};
+}
+
 Vec3 horizontalToENU(const Horizontal& horizontal) {
   const double cosAlt = std::cos(horizontal.altRad);
   return {
@@ -20,23 +28,76 @@ Vec3 rotateToDevice(const Vec3& enu, const Quaternion& orientation) {
   return orientation.rotate(enu);
 }
 
-bool projectToScreen(const Vec3& deviceVec, const EngineConfig& config, float& outX, float& outY) {
+ScreenProjection makeScreenProjection(const EngineConfig& config) {
+  ScreenProjection projection;
+  projection.halfWidth = static_cast<double>(config.screen.width) * 0.5;
+  projection.halfHeight = static_cast<double>(config.screen.height) * 0.5;
+  projection.focalLength = projection.halfWidth / std::tan(config.fovDeg * kDegToRad * 0.5);
+  projection.width = static_cast<float>(config.screen.width);
+  projection.height = static_cast<float>(config.screen.height);
+  return projection;
+}
+
+bool projectToScreen(const Vec3& deviceVec, const ScreenProjection& projection, float& outX, float& outY) {
   if (deviceVec.z <= 0.0) {
     return false;
   }
 
-  const double halfWidth = static_cast<double>(config.screen.width) * 0.5;
-  const double halfHeight = static_cast<double>(config.screen.height) * 0.5;
-  const double fovRad = config.fovDeg * kDegToRad;
-  const double focalLength = halfWidth / std::tan(fovRad * 0.5);
+  const double ndcX = (deviceVec.x / deviceVec.z) * projection.focalLength;
+  const double ndcY = (deviceVec.y / deviceVec.z) * projection.focalLength;
 
-  const double ndcX = (deviceVec.x / deviceVec.z) * focalLength;
-  const double ndcY = (deviceVec.y / deviceVec.z) * focalLength;
+  outX = static_cast<float>(projection.halfWidth + ndcX);
+  outY = static_cast<float>(projection.halfHeight - ndcY);
 
-  outX = static_cast<float>(halfWidth + ndcX);
-  outY = static_cast<float>(halfHeight - ndcY);
+  return outX >= 0.0f && outX <= projection.width && outY >= 0.0f && outY <= projection.height;
+}
 
-  return outX >= 0.0f && outX <= config.screen.width && outY >= 0.0f && outY <= config.screen.height;
+bool projectToScreen(const Vec3& deviceVec, const EngineConfig& config, float& outX, float& outY) {
+  return projectToScreen(deviceVec, makeScreenProjection(config), outX, outY);
+}
+
+void horizontalToENU(std::span<const double> altRad,
+                     std::span<const double> azRad,
+                     std::span<double> east,
+                     std::span<double> north,
+                     std::span<double> up) {
+  const std::size_t n = std::min({altRad.size(), azRad.size(), east.size(), north.size(), up.size()});
+  for (std::size_t i = 0; i < n; ++i) {
+    const double cosAlt = std::cos(altRad[i]);
+    east[i] = cosAlt * std::sin(azRad[i]);
+    north[i] = cosAlt * std::cos(azRad[i]);
+    up[i] = std::sin(altRad[i]);
+  }
+}
+
+std::size_t projectToScreen(std::span<const double> deviceX,
+                            std::span<const double> deviceY,
+                            std::span<const double> deviceZ,
+                            const ScreenProjection& projection,
+                            std::span<float> outX,
+                            std::span<float> outY,
+                            std::span<std::uint8_t> visible) {
+  const std::size_t n = std::min(
+      {deviceX.size(), deviceY.size(), deviceZ.size(), outX.size(), outY.size(), visible.size()});
+  const double focalLength = projection.focalLength;
+  const double halfWidth = projection.halfWidth;
+  const double halfHeight = projection.halfHeight;
+  const float width = projection.width;
+  const float height = projection.height;
+  // Branch-free so the loop vectorizes; directions behind the camera divide
+  // by a non-positive z and are masked out afterwards.
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    const double z = deviceZ[i];
+    const auto x = static_cast<float>(halfWidth + (deviceX[i] / z) * focalLength);
+    const auto y = static_cast<float>(halfHeight - (deviceY[i] / z) * focalLength);
+    const bool onScreen = (z > 0.0) & (x >= 0.0f) & (x <= width) & (y >= 0.0f) & (y <= height);
+    outX[i] = x;
+    outY[i] = y;
+    visible[i] = static_cast<std::uint8_t>(onScreen);
+    count += static_cast<std::size_t>(onScreen);
+  }
+  return count;
 }
 
 }  // namespace astro::vector
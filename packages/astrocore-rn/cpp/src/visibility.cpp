@@ -0,0 +1,314 @@
+#include "astro/visibility.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <thread>
+
+#include "WorkerPool.hpp"
+#include "astro/time.hpp"
+#include "astro/trace.hpp"
+#include "astro/transform.hpp"
+
+namespace astro::visibility {
+
+namespace {
+constexpr double kDegToRad = 0.01745329251994329577;
+constexpr double kHalfPi = 1.57079632679489661923;
+constexpr float kTwoPi = 6.28318530717958647692f;
+
+const transform::RefractionLiftTable& liftTable() {
+  static const transform::RefractionLiftTable table;
+  return table;
+}
+
+struct Site {
+  float sinLat{0.0f};
+  float cosLat{1.0f};
+  float refractionFactor{0.0f};
+  // Bitsets: the smallest unrefracted sin(alt) that counts as visible.
+  float minSinAlt{0.0f};
+};
+
+// Observers with one longitude, as a run of Plan::order.
+struct Meridian {
+  double lonRad{0.0};
+  std::size_t begin{0};
+  std::size_t end{0};
+};
+
+// Everything the tasks share, worked out once per call.
+struct Plan {
+  std::size_t stars{0};
+  // Catalog unit vectors in input order.
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<float> z;
+  std::vector<double> gmstRad;
+  std::vector<Site> sites;
+  // Observer indices sorted by longitude.
+  std::vector<std::size_t> order;
+  std::vector<Meridian> meridians;
+};
+
+// Threads for `tasks` tasks, including the caller.
+std::size_t threadCount(std::size_t requested, std::size_t tasks) {
+  const std::size_t threads = requested != 0 ? requested : std::thread::hardware_concurrency();
+  return std::clamp<std::size_t>(threads, 1, std::max<std::size_t>(tasks, 1));
+}
+
+// Copies the catalog unit vectors into input order.
+void gatherInputOrder(const StarCatalog& catalog, std::vector<float>& x, std::vector<float>& y, std::vector<float>& z) {
+  x.resize(catalog.size());
+  y.resize(catalog.size());
+  z.resize(catalog.size());
+  for (std::size_t i = 0; i < catalog.size(); ++i) {
+    const std::uint32_t slot = catalog.slotOf(i);
+    x[i] = catalog.x()[slot];
+    y[i] = catalog.y()[slot];
+    z[i] = catalog.z()[slot];
+  }
+}
+
+// Smallest true altitude whose refracted altitude reaches `minAltRad`.
+// applyRefraction() only ever lifts and never reverses order, so the
+// predicate is monotonic and bisection finds the edge.
+double unrefractedThreshold(double minAltRad, double factor) {
+  double lo = -kHalfPi;
+  double hi = minAltRad;
+  for (int i = 0; i < 64; ++i) {
+    const double mid = 0.5 * (lo + hi);
+    (transform::applyRefraction(mid, factor) >= minAltRad ? hi : lo) = mid;
+  }
+  return hi;
+}
+
+Plan makePlan(const StarCatalog& catalog,
+              std::span<const Observer> observers,
+              std::span<const double> jds,
+              const GridOptions& options) {
+  Plan plan;
+  plan.stars = catalog.size();
+  gatherInputOrder(catalog, plan.x, plan.y, plan.z);
+
+  plan.gmstRad.reserve(jds.size());
+  for (const double jd : jds) {
+    plan.gmstRad.push_back(time::julianDateToGMSTRad(jd));
+  }
+
+  const double minAltRad = options.minAltDeg * kDegToRad;
+  plan.sites.reserve(observers.size());
+  for (const Observer& observer : observers) {
+    const double latRad = observer.latDeg * kDegToRad;
+    const double factor = options.applyRefraction ? transform::refractionFactor(observer) : 0.0;
+    const double threshold = factor > 0.0 ? unrefractedThreshold(minAltRad, factor) : minAltRad;
+    plan.sites.push_back({static_cast<float>(std::sin(latRad)),
+                          static_cast<float>(std::cos(latRad)),
+                          static_cast<float>(factor),
+                          static_cast<float>(std::sin(threshold))});
+  }
+
+  plan.order.resize(observers.size());
+  std::iota(plan.order.begin(), plan.order.end(), std::size_t{0});
+  std::stable_sort(plan.order.begin(), plan.order.end(), [&](std::size_t a, std::size_t b) {
+    return observers[a].lonDeg < observers[b].lonDeg;
+  });
+  for (std::size_t i = 0; i < plan.order.size(); ++i) {
+    const double lonDeg = observers[plan.order[i]].lonDeg;
+    if (plan.meridians.empty() || observers[plan.order[i - 1]].lonDeg != lonDeg) {
+      plan.meridians.push_back({lonDeg * kDegToRad, i, i});
+    }
+    plan.meridians.back().end = i + 1;
+  }
+  return plan;
+}
+
+// Runs fn(time, meridian, sinLst, cosLst) for every (time, meridian) task.
+template <typename Fn>
+void forEachTask(const Plan& plan, const GridOptions& options, Fn&& fn) {
+  const std::size_t tasks = plan.gmstRad.size() * plan.meridians.size();
+  if (tasks == 0) {
+    return;
+  }
+  auto task = [&](std::size_t index) {
+    const std::size_t time = index / plan.meridians.size();
+    const Meridian& meridian = plan.meridians[index % plan.meridians.size()];
+    const double lstRad = plan.gmstRad[time] + meridian.lonRad;
+    fn(time, meridian, static_cast<float>(std::sin(lstRad)), static_cast<float>(std::cos(lstRad)));
+  };
+  WorkerPool pool(threadCount(options.threads, tasks) - 1);
+  pool.parallelFor(tasks, task);
+}
+
+// Stars per computeTracks() task. The running directions of a block stay in
+// L1 across all samples.
+constexpr std::size_t kTrackBlock = 1024;
+
+// A rotation in single precision, row-major.
+std::array<float, 9> toFloat(const Mat3& m) {
+  std::array<float, 9> out{};
+  for (int r = 0; r < 3; ++r) {
+    for (int c = 0; c < 3; ++c) {
+      out[r * 3 + c] = static_cast<float>(m.m[r][c]);
+    }
+  }
+  return out;
+}
+}  // namespace
+
+Bitsets computeBitsets(const StarCatalog& catalog,
+                       std::span<const Observer> observers,
+                       std::span<const double> jds,
+                       const GridOptions& options) {
+  trace::Span span("visibility", "computeBitsets");
+  const Plan plan = makePlan(catalog, observers, jds, options);
+  Bitsets out;
+  out.times = jds.size();
+  out.observers = observers.size();
+  out.stars = plan.stars;
+  out.rowWords = (plan.stars + 63) / 64;
+  out.words.assign(out.times * out.observers * out.rowWords, 0);
+
+  forEachTask(plan, options, [&](std::size_t time, const Meridian& meridian, float sinLst, float cosLst) {
+    // Component of each star towards the local meridian at the equator; up
+    // is then one multiply-add per observer.
+    std::vector<float> meridianX(plan.stars);
+    for (std::size_t i = 0; i < plan.stars; ++i) {
+      meridianX[i] = cosLst * plan.x[i] + sinLst * plan.y[i];
+    }
+    for (std::size_t k = meridian.begin; k < meridian.end; ++k) {
+      const std::size_t observer = plan.order[k];
+      const Site& site = plan.sites[observer];
+      std::uint64_t* row = out.words.data() + (time * out.observers + observer) * out.rowWords;
+      for (std::size_t word = 0; word < out.rowWords; ++word) {
+        const std::size_t first = word * 64;
+        const std::size_t count = std::min<std::size_t>(64, plan.stars - first);
+        std::uint64_t bits = 0;
+        for (std::size_t b = 0; b < count; ++b) {
+          const float up = site.cosLat * meridianX[first + b] + site.sinLat * plan.z[first + b];
+          bits |= static_cast<std::uint64_t>(up >= site.minSinAlt) << b;
+        }
+        row[word] = bits;
+      }
+    }
+  });
+  return out;
+}
+
+bool computeAltAz(const StarCatalog& catalog,
+                  std::span<const Observer> observers,
+                  std::span<const double> jds,
+                  std::span<float> altAz,
+                  const GridOptions& options) {
+  if (altAz.size() < altAzFloats(jds.size(), observers.size(), catalog.size())) {
+    return false;
+  }
+  trace::Span span("visibility", "computeAltAz");
+  const Plan plan = makePlan(catalog, observers, jds, options);
+  const transform::RefractionLiftTable& lift = liftTable();
+
+  forEachTask(plan, options, [&](std::size_t time, const Meridian& meridian, float sinLst, float cosLst) {
+    // Each star in the frame of the local meridian at the equator: towards
+    // the meridian and towards the east. Only the north/up split below
+    // depends on the observer's latitude.
+    std::vector<float> meridianX(plan.stars);
+    std::vector<float> east(plan.stars);
+    for (std::size_t i = 0; i < plan.stars; ++i) {
+      meridianX[i] = cosLst * plan.x[i] + sinLst * plan.y[i];
+      east[i] = cosLst * plan.y[i] - sinLst * plan.x[i];
+    }
+    for (std::size_t k = meridian.begin; k < meridian.end; ++k) {
+      const std::size_t observer = plan.order[k];
+      const Site& site = plan.sites[observer];
+      float* out = altAz.data() + (time * observers.size() + observer) * plan.stars * 2;
+      for (std::size_t i = 0; i < plan.stars; ++i) {
+        const float up = std::clamp(site.cosLat * meridianX[i] + site.sinLat * plan.z[i], -1.0f, 1.0f);
+        const float north = site.cosLat * plan.z[i] - site.sinLat * meridianX[i];
+        float alt = std::asin(up);
+        if (site.refractionFactor > 0.0f) {
+          alt += site.refractionFactor * lift.lift(up);
+        }
+        const float az = std::atan2(east[i], north);
+        out[2 * i] = alt;
+        out[2 * i + 1] = az < 0.0f ? az + kTwoPi : az;
+      }
+    }
+  });
+  return true;
+}
+
+bool computeTracks(const StarCatalog& catalog,
+                   const Observer& observer,
+                   double jd0,
+                   double dtDays,
+                   std::size_t samples,
+                   std::span<float> enu,
+                   const TrackOptions& options) {
+  const std::size_t stars = catalog.size();
+  if (enu.size() < trackFloats(samples, stars)) {
+    return false;
+  }
+  trace::Span span("visibility", "computeTracks");
+  span.setCount(static_cast<std::int64_t>(samples * stars));
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<float> z;
+  gatherInputOrder(catalog, x, y, z);
+
+  // M(lst + d) * M(lst)^T is the same turn about the pole for every lst, so
+  // one step matrix serves the whole track. Only its angle needs GMST, and
+  // a wrap of a full turn does not change it.
+  const double stepRad = time::julianDateToGMSTRad(jd0 + dtDays) - time::julianDateToGMSTRad(jd0);
+  const std::array<float, 9> step = toFloat(transform::equatorialToENUMatrix(stepRad, observer.latDeg) *
+                                            transform::equatorialToENUMatrix(0.0, observer.latDeg).transposed());
+  const std::size_t anchorInterval = std::max<std::size_t>(options.anchorInterval, 1);
+  std::vector<std::array<float, 9>> anchors;
+  for (std::size_t k = 0; k < samples; k += anchorInterval) {
+    const double jd = jd0 + static_cast<double>(k) * dtDays;
+    anchors.push_back(toFloat(transform::equatorialToENUMatrix(time::localSiderealTimeRad(jd, observer.lonDeg),
+                                                               observer.latDeg)));
+  }
+
+  const std::size_t blocks = (stars + kTrackBlock - 1) / kTrackBlock;
+  auto task = [&](std::size_t block) {
+    const std::size_t begin = block * kTrackBlock;
+    const std::size_t count = std::min(kTrackBlock, stars - begin);
+    std::array<float, kTrackBlock> east;
+    std::array<float, kTrackBlock> north;
+    std::array<float, kTrackBlock> up;
+    for (std::size_t k = 0; k < samples; ++k) {
+      if (k % anchorInterval == 0) {
+        const std::array<float, 9>& m = anchors[k / anchorInterval];
+        for (std::size_t i = 0; i < count; ++i) {
+          const float sx = x[begin + i];
+          const float sy = y[begin + i];
+          const float sz = z[begin + i];
+          east[i] = m[0] * sx + m[1] * sy + m[2] * sz;
+          north[i] = m[3] * sx + m[4] * sy + m[5] * sz;
+          up[i] = m[6] * sx + m[7] * sy + m[8] * sz;
+        }
+      } else {
+        for (std::size_t i = 0; i < count; ++i) {
+          const float e = east[i];
+          const float n = north[i];
+          const float u = up[i];
+          east[i] = step[0] * e + step[1] * n + step[2] * u;
+          north[i] = step[3] * e + step[4] * n + step[5] * u;
+          up[i] = step[6] * e + step[7] * n + step[8] * u;
+        }
+      }
+      float* out = enu.data() + (k * stars + begin) * 3;
+      for (std::size_t i = 0; i < count; ++i) {
+        out[3 * i] = east[i];
+        out[3 * i + 1] = north[i];
+        out[3 * i + 2] = up[i];
+      }
+    }
+  };
+  WorkerPool pool(threadCount(options.threads, blocks) - 1);
+  pool.parallelFor(blocks, task);
+  return true;
+}
+
+}  // namespace astro::visibility
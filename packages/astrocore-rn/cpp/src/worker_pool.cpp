@@ -0,0 +1,77 @@
+#include "WorkerPool.hpp"
+
+#include "astro/trace.hpp"
+
+namespace astro {
+
+WorkerPool::WorkerPool(std::size_t helperThreads) {
+  threads_.reserve(helperThreads);
+  for (std::size_t i = 0; i < helperThreads; ++i) {
+    threads_.emplace_back([this] { workerLoop(); });
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void WorkerPool::run(std::size_t taskCount, TaskFn fn, void* context) {
+  if (taskCount == 0) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    fn_ = fn;
+    context_ = context;
+    taskCount_ = taskCount;
+    nextTask_.store(0, std::memory_order_relaxed);
+    busyWorkers_ = threads_.size();
+    generation_ += 1;
+  }
+  wake_.notify_all();
+
+  drainTasks();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_.wait(lock, [this] { return busyWorkers_ == 0; });
+}
+
+void WorkerPool::drainTasks() {
+  for (std::size_t task = nextTask_.fetch_add(1, std::memory_order_relaxed); task < taskCount_;
+       task = nextTask_.fetch_add(1, std::memory_order_relaxed)) {
+    fn_(context_, task);
+  }
+}
+
+void WorkerPool::workerLoop() {
+  trace::setThreadName("astro-worker");
+  std::uint64_t seenGeneration = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait(lock, [&] { return stopping_ || generation_ != seenGeneration; });
+      if (stopping_) {
+        return;
+      }
+      seenGeneration = generation_;
+    }
+
+    drainTasks();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    busyWorkers_ -= 1;
+    if (busyWorkers_ == 0) {
+      idle_.notify_one();
+    }
+  }
+}
+
+}  // namespace astro
@@ -0,0 +1,139 @@
+#include "astro/catalog.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr double kDegToRad = 0.01745329251994329577;
+
+std::vector<astro::StarIn> unpack(const std::vector<float>& records) {
+  std::vector<astro::StarIn> stars;
+  for (std::size_t i = 0; i < records.size(); i += astro::kPackedStarFloats) {
+    stars.push_back({records[i], records[i + 1], records[i + 2], static_cast<int>(records[i + 3])});
+  }
+  return stars;
+}
+
+// Same stars at the same input positions, same tiles, and leaves still
+// brightest first. Slots may differ between equally bright stars.
+void checkMatches(const astro::StarCatalog& actual, const astro::StarCatalog& expected) {
+  assert(actual.size() == expected.size());
+  for (std::size_t i = 0; i < expected.size(); ++i) {
+    const std::uint32_t a = actual.slotOf(i);
+    const std::uint32_t e = expected.slotOf(i);
+    assert(actual.x()[a] == expected.x()[e]);
+    assert(actual.y()[a] == expected.y()[e]);
+    assert(actual.z()[a] == expected.z()[e]);
+    assert(actual.mag()[a] == expected.mag()[e]);
+    assert(actual.hip()[a] == expected.hip()[e]);
+  }
+  const auto tiles = actual.index().tiles();
+  const auto expectedTiles = expected.index().tiles();
+  assert(tiles.size() == expectedTiles.size());
+  assert(std::memcmp(tiles.data(), expectedTiles.data(), tiles.size_bytes()) == 0);
+  for (const auto& leaf : actual.index().level(actual.index().levels())) {
+    for (std::uint32_t i = leaf.begin + 1; i < leaf.end; ++i) {
+      assert(actual.mag()[i - 1] <= actual.mag()[i]);
+    }
+  }
+}
+
+}  // namespace
+
+int main() {
+  std::vector<float> records;
+  for (int i = 0; i < 5000; ++i) {
+    const double ra = static_cast<double>((i * 7919) % 36000) * 0.01;
+    const double dec = std::asin(static_cast<double>((i * 104729) % 20000) / 10000.0 - 1.0) / kDegToRad;
+    records.insert(records.end(),
+                   {static_cast<float>(ra), static_cast<float>(dec), static_cast<float>((i % 70) * 0.1),
+                    static_cast<float>(i + 1)});
+  }
+
+  // Packed records read in place build the same catalog as StarIn input.
+  astro::StarCatalog catalog;
+  catalog.assignPacked(records);
+  {
+    astro::StarCatalog reference;
+    reference.assign(unpack(records));
+    checkMatches(catalog, reference);
+  }
+
+  // Patching magnitudes re-sorts and refits only the touched leaves.
+  for (std::size_t i = 100; i < 150; ++i) {
+    records[i * 4 + 2] = static_cast<float>(7.0 - records[i * 4 + 2]);
+  }
+  const bool repatched = catalog.updatePacked(100, std::span<const float>(records).subspan(400, 200));
+  assert(repatched);
+  {
+    astro::StarCatalog reference;
+    reference.assign(unpack(records));
+    checkMatches(catalog, reference);
+  }
+
+  // Moving stars across leaves re-sorts the storage.
+  std::vector<astro::StarIn> moved = unpack(records);
+  for (std::size_t i = 10; i < 20; ++i) {
+    moved[i].raDeg = std::fmod(moved[i].raDeg + 30.0, 360.0);
+    moved[i].decDeg = -moved[i].decDeg;
+  }
+  const bool movedStars = catalog.update(10, std::span<const astro::StarIn>(moved).subspan(10, 10));
+  assert(movedStars);
+  {
+    astro::StarCatalog reference;
+    reference.assign(moved);
+    checkMatches(catalog, reference);
+  }
+
+  // Colors follow their stars through later re-sorts. A patch keeps a star's
+  // color unless it carries a B-V of its own.
+  std::vector<float> colors(catalog.size());
+  for (std::size_t i = 0; i < colors.size(); ++i) {
+    colors[i] = static_cast<float>(i % 240) * 0.01f - 0.4f;
+  }
+  const bool colored = catalog.updateColors(0, colors);
+  const bool coloredPastEnd = catalog.updateColors(1, colors);
+  assert(colored && !coloredPastEnd);
+  moved[30].raDeg = std::fmod(moved[30].raDeg + 90.0, 360.0);
+  const bool crossed = catalog.update(30, std::span<const astro::StarIn>(moved).subspan(30, 1));
+  assert(crossed);
+  moved[31].bv = 1.25;
+  const bool recolored = catalog.update(31, std::span<const astro::StarIn>(moved).subspan(31, 1));
+  const std::vector<float> record = {200.0f, 10.0f, 3.0f, 32.0f};
+  const bool repacked = catalog.updatePacked(32, record);
+  assert(recolored && repacked);
+  for (std::size_t i = 0; i < colors.size(); ++i) {
+    const float bv = catalog.bv()[catalog.slotOf(i)];
+    assert(bv == (i == 31 ? 1.25f : colors[i]));
+  }
+
+  // Ranges past the end are rejected untouched.
+  assert(!catalog.update(4995, std::span<const astro::StarIn>(moved).subspan(0, 10)));
+  assert(!catalog.updatePacked(5001, {}));
+
+  // A mapped catalog is patched in file order after copying it out.
+  const std::string path = "test_catalog.bin";
+  const auto written = astro::writeCatalogFile(path, catalog);
+  assert(written == astro::CatalogFileStatus::Ok);
+  astro::StarCatalog mapped;
+  const auto status = mapped.load(path);
+  assert(status == astro::CatalogFileStatus::Ok);
+  std::remove(path.c_str());
+  const std::uint32_t slot = 42;
+  astro::StarIn star{200.0, 10.0, -1.0, 777};
+  const bool patchedMapped = mapped.update(slot, std::span<const astro::StarIn>(&star, 1));
+  assert(patchedMapped);
+  assert(!mapped.mapped());
+  bool found = false;
+  for (std::size_t i = 0; i < mapped.size(); ++i) {
+    found = found || (mapped.hip()[i] == 777 && mapped.mag()[i] == -1.0f);
+  }
+  assert(found);
+  assert(mapped.hip()[mapped.slotOf(slot)] == 777);
+
+  return 0;
+}
@@ -0,0 +1,150 @@
+#include "RingBuffer.hpp"
+#include "astro/catalog.hpp"
+#include "astro/engine.hpp"
+#include "astro/time.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr double kDegToRad = 0.01745329251994329577;
+
+bool sameColumns(const astro::StarCatalog& a, const astro::StarCatalog& b) {
+  const std::size_t n = a.size();
+  return n == b.size() && std::memcmp(a.x(), b.x(), n * sizeof(float)) == 0 &&
+         std::memcmp(a.y(), b.y(), n * sizeof(float)) == 0 &&
+         std::memcmp(a.z(), b.z(), n * sizeof(float)) == 0 &&
+         std::memcmp(a.mag(), b.mag(), n * sizeof(float)) == 0 &&
+         std::memcmp(a.hip(), b.hip(), n * sizeof(std::int32_t)) == 0 &&
+         std::memcmp(a.bv(), b.bv(), n * sizeof(float)) == 0;
+}
+
+bool sameTiles(const astro::SkyIndex& a, const astro::SkyIndex& b) {
+  return a.levels() == b.levels() && a.tiles().size() == b.tiles().size() &&
+         std::memcmp(a.tiles().data(), b.tiles().data(), a.tiles().size_bytes()) == 0;
+}
+
+}  // namespace
+
+int main() {
+  std::vector<astro::StarIn> stars;
+  for (int i = 0; i < 7001; ++i) {
+    const double ra = static_cast<double>((i * 7919) % 36000) * 0.01;
+    const double dec = std::asin(static_cast<double>((i * 104729) % 20000) / 10000.0 - 1.0) / kDegToRad;
+    stars.push_back({ra, dec, (i % 70) * 0.1, i + 1, (i % 5) * 0.4 - 0.3});
+  }
+  astro::StarCatalog source;
+  source.assign(stars);
+
+  const std::string path = "test_catalog_file.bin";
+  const std::string pathNoTiles = "test_catalog_file_notiles.bin";
+  const auto written = astro::writeCatalogFile(path, source);
+  const auto writtenNoTiles = astro::writeCatalogFile(pathNoTiles, source, false);
+  assert(written == astro::CatalogFileStatus::Ok && writtenNoTiles == astro::CatalogFileStatus::Ok);
+
+  // Both layouts map back to the same columns and index, read in place.
+  for (const std::string& file : {path, pathNoTiles}) {
+    astro::StarCatalog loaded;
+    const auto status = loaded.load(file);
+    assert(status == astro::CatalogFileStatus::Ok);
+    assert(loaded.mapped());
+    assert(loaded.sortedByMagnitude());
+    assert(sameColumns(source, loaded));
+    assert(sameTiles(source.index(), loaded.index()));
+    assert(reinterpret_cast<std::uintptr_t>(loaded.x()) % astro::kCacheLineSize == 0);
+  }
+
+  // The engine renders a mapped catalog exactly like an assigned one.
+  {
+    astro::AstroEngine engine;
+    astro::EngineConfig config{};
+    config.screen.width = 1080;
+    config.screen.height = 1920;
+    engine.setConfig(config);
+    engine.setObserver({37.7749, -122.4194, 0.0});
+    engine.updatePose({0.9238795, 0.3826834, 0.0, 0.0});
+    const double jd = astro::time::unixMillisToJulianDate(1700000000000ULL);
+
+    engine.setStars(stars);
+    const std::size_t count = engine.computeFrame(jd);
+    const auto first = engine.ringBuffer().readSpan();
+    const std::vector<float> assigned(first.begin(), first.end());
+    assert(count > 0);
+
+    const auto status = engine.loadCatalog(path);
+    assert(status == astro::CatalogFileStatus::Ok);
+    const std::size_t mappedCount = engine.computeFrame(jd);
+    assert(mappedCount == count);
+    const auto mapped = engine.ringBuffer().readSpan();
+    assert(std::memcmp(mapped.data(), assigned.data(), assigned.size() * sizeof(float)) == 0);
+
+    // A failed load keeps the current catalog.
+    const auto missing = engine.loadCatalog("missing_catalog.bin");
+    assert(missing == astro::CatalogFileStatus::OpenFailed);
+    const std::size_t keptCount = engine.computeFrame(jd);
+    assert(keptCount == count);
+  }
+
+  // Damaged files are rejected.
+  std::vector<char> bytes;
+  {
+    std::ifstream in(path, std::ios::binary);
+    bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+  auto loadBytes = [&](const std::vector<char>& data) {
+    const std::string damaged = "test_catalog_file_damaged.bin";
+    std::ofstream(damaged, std::ios::binary).write(data.data(), static_cast<std::streamsize>(data.size()));
+    astro::StarCatalog catalog;
+    return catalog.load(damaged);
+  };
+  {
+    std::vector<char> data = bytes;
+    data[0] = 'X';
+    assert(loadBytes(data) == astro::CatalogFileStatus::BadMagic);
+  }
+  {
+    std::vector<char> data = bytes;
+    data[offsetof(astro::CatalogFileHeader, version)] = 99;
+    assert(loadBytes(data) == astro::CatalogFileStatus::UnsupportedVersion);
+  }
+  {
+    // Version 1 files have no color section and load white.
+    std::vector<char> data = bytes;
+    data[offsetof(astro::CatalogFileHeader, version)] = 1;
+    const std::string old = "test_catalog_file_v1.bin";
+    std::ofstream(old, std::ios::binary).write(data.data(), static_cast<std::streamsize>(data.size()));
+    astro::StarCatalog catalog;
+    const auto status = catalog.load(old);
+    assert(status == astro::CatalogFileStatus::Ok);
+    assert(catalog.bv() == nullptr && catalog.size() == source.size());
+    const bool colored = catalog.updateColors(0, {});
+    assert(colored && catalog.bv() != nullptr && std::isnan(catalog.bv()[0]));
+    std::remove(old.c_str());
+  }
+  {
+    std::vector<char> data(bytes.begin(), bytes.end() - 8);
+    assert(loadBytes(data) == astro::CatalogFileStatus::Truncated);
+  }
+  {
+    // A tile overlapping its neighbour no longer partitions the stars.
+    std::vector<char> data = bytes;
+    astro::CatalogFileHeader header;
+    std::memcpy(&header, data.data(), sizeof(header));
+    const auto* tiles = reinterpret_cast<const astro::SkyTile*>(data.data() + header.tilesOffset);
+    astro::SkyTile tile = tiles[0];
+    tile.end += 1;
+    std::memcpy(data.data() + header.tilesOffset, &tile, sizeof(tile));
+    assert(loadBytes(data) == astro::CatalogFileStatus::Corrupt);
+  }
+
+  std::remove(path.c_str());
+  std::remove(pathNoTiles.c_str());
+  std::remove("test_catalog_file_damaged.bin");
+  return 0;
+}
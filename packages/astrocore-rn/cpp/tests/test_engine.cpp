@@ -1,8 +1,64 @@
+#include "RingBuffer.hpp"
 #include "astro/engine.hpp"
 #include "astro/time.hpp"
+#include "astro/transform.hpp"
+#include "astro/vector.hpp"
 
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <cmath>
+#include <cstring>
+#include <span>
+#include <vector>
+
+namespace {
+
+// Per-star pipeline the engine is expected to reproduce.
+std::size_t referenceFrame(const std::vector<astro::StarIn>& stars,
+                           const astro::EngineConfig& config,
+                           const astro::Observer& observer,
+                           const astro::PoseQuat& pose,
+                           double jd,
+                           std::vector<float>& out) {
+  const float limit = static_cast<float>(config.limitingMag);
+  const double lst = astro::time::localSiderealTimeRad(jd, observer.lonDeg);
+  const auto orientation = astro::Quaternion::fromPose(pose);
+  out.clear();
+  for (const auto& star : stars) {
+    if (static_cast<float>(star.mag) > limit) {
+      continue;
+    }
+    auto horizontal = astro::transform::equatorialToHorizontal(star.raDeg, star.decDeg, lst, observer.latDeg);
+    if (config.applyRefraction) {
+      horizontal.altRad =
+          astro::transform::applyRefraction(horizontal.altRad, astro::transform::refractionFactor(observer));
+    }
+    if (horizontal.altRad <= 0.0) {
+      continue;
+    }
+    const auto deviceVec = astro::vector::rotateToDevice(astro::vector::horizontalToENU(horizontal), orientation);
+    float x = 0.0f;
+    float y = 0.0f;
+    if (!astro::vector::projectToScreen(deviceVec, config, x, y)) {
+      continue;
+    }
+    out.insert(out.end(), {x, y, static_cast<float>(star.mag), static_cast<float>(star.hip)});
+  }
+  return out.size() / 4;
+}
+
+// The engine emits stars in sky-index order; compare frames ordered by id.
+std::vector<float> sortedByHip(std::span<const float> frame) {
+  std::vector<std::array<float, 4>> records(frame.size() / 4);
+  std::memcpy(records.data(), frame.data(), frame.size() * sizeof(float));
+  std::sort(records.begin(), records.end(), [](const auto& a, const auto& b) { return a[3] < b[3]; });
+  std::vector<float> out(frame.size());
+  std::memcpy(out.data(), records.data(), frame.size() * sizeof(float));
+  return out;
+}
+
+}  // namespace
 
 int main() {
   astro::AstroEngine engine;
@@ -36,5 +92,210 @@ int main() {
   assert(buffer.count() == visible);
   assert(buffer.stride() == 4);
 
+  // The matrix pipeline must agree with the per-star trigonometric pipeline.
+  std::vector<astro::StarIn> grid;
+  int hip = 1;
+  for (double dec = -85.0; dec <= 85.0; dec += 2.5) {
+    for (double ra = 0.0; ra < 360.0; ra += 2.5) {
+      grid.push_back({ra, dec, 1.0 + (hip % 60) * 0.1, hip});
+      hip += 1;
+    }
+  }
+  engine.setStars(grid);
+
+  const std::array<astro::PoseQuat, 3> poses{{
+      {1.0, 0.0, 0.0, 0.0},
+      {0.9238795, 0.3826834, 0.0, 0.0},
+      {0.8, 0.2, -0.4, 0.4},
+  }};
+  std::vector<float> expected;
+  for (const auto& pose : poses) {
+    for (bool refraction : {true, false}) {
+      config.applyRefraction = refraction;
+      engine.setConfig(config);
+      engine.updatePose(pose);
+
+      const std::size_t count = engine.computeFrame(jd);
+      const std::size_t expectedCount = referenceFrame(grid, config, observer, pose, jd, expected);
+      assert(count > 0);
+      assert(count == expectedCount);
+
+      const auto frame = sortedByHip(engine.ringBuffer().readSpan());
+      expected = sortedByHip(expected);
+      for (std::size_t i = 0; i < expected.size(); ++i) {
+        assert(std::fabs(frame[i] - expected[i]) < 1e-2f);
+      }
+    }
+  }
+
+  // Thin, cold air at altitude changes the refraction the engine applies.
+  {
+    astro::Observer mountain = observer;
+    mountain.elevationM = 4200.0;
+    mountain.temperatureC = -15.0;
+    config.applyRefraction = true;
+    engine.setConfig(config);
+    engine.setObserver(mountain);
+    engine.updatePose(poses[1]);
+    const std::size_t count = engine.computeFrame(jd);
+    assert(count == referenceFrame(grid, config, mountain, poses[1], jd, expected));
+    const auto frame = sortedByHip(engine.ringBuffer().readSpan());
+    expected = sortedByHip(expected);
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+      assert(std::fabs(frame[i] - expected[i]) < 1e-2f);
+    }
+    engine.setObserver(observer);
+    config.applyRefraction = false;
+    engine.setConfig(config);
+  }
+
+  // A limiting magnitude drops faint stars whether the catalog is sorted
+  // (per-tile cut) or not (per-star test in the kernel).
+  for (bool sortByMagnitude : {true, false}) {
+    astro::CatalogOptions options;
+    options.sortByMagnitude = sortByMagnitude;
+    engine.setStars(grid, options);
+    config.limitingMag = 3.45;
+    engine.setConfig(config);
+    engine.updatePose(poses[0]);
+
+    const std::size_t count = engine.computeFrame(jd);
+    assert(count > 0);
+    assert(count == referenceFrame(grid, config, observer, poses[0], jd, expected));
+    const auto frame = engine.ringBuffer().readSpan();
+    for (std::size_t i = 0; i < count; ++i) {
+      assert(frame[i * 4 + 2] <= 3.45f);
+    }
+  }
+
+  // Following the FOV: halving the view deepens the limit by 5 * log10(2).
+  config.limitingMagFollowsFov = true;
+  config.fovDeg = 30.0;
+  engine.setConfig(config);
+  engine.setLimitingMag(3.45 - 5.0 * std::log10(2.0));
+  {
+    const std::size_t count = engine.computeFrame(jd);
+    astro::EngineConfig reference = config;
+    reference.limitingMag = 3.45;
+    assert(count == referenceFrame(grid, reference, observer, poses[0], jd, expected));
+  }
+  config = astro::EngineConfig{};
+  config.fovDeg = 60.0;
+  config.screen.width = 1080;
+  config.screen.height = 1920;
+  engine.setConfig(config);
+  engine.setStars(grid);
+
+  // Inside the sidereal tolerance a later frame reuses the cached rotation;
+  // with no tolerance the sky visibly moves.
+  {
+    engine.updatePose(poses[1]);
+    const std::size_t count = engine.computeFrame(jd);
+    const auto first = engine.ringBuffer().readSpan();
+    const std::vector<float> cached(first.begin(), first.end());
+
+    const double jdLater = jd + 10.0 / 86400.0;
+    config.siderealToleranceDeg = 1.0;
+    engine.setConfig(config);
+    const std::size_t reusedCount = engine.computeFrame(jdLater);
+    assert(reusedCount == count);
+    const auto reused = engine.ringBuffer().readSpan();
+    assert(std::memcmp(reused.data(), cached.data(), cached.size() * sizeof(float)) == 0);
+
+    config.siderealToleranceDeg = 0.0;
+    engine.setConfig(config);
+    engine.computeFrame(jdLater);
+    const auto moved = engine.ringBuffer().readSpan();
+    assert(moved.size() != cached.size() ||
+           std::memcmp(moved.data(), cached.data(), cached.size() * sizeof(float)) != 0);
+    config.siderealToleranceDeg = astro::EngineConfig{}.siderealToleranceDeg;
+  }
+
+  // Apparent places: J2000 stars are precessed, nutated and aberrated to the
+  // date, which at 2023 moves them by about a third of a degree.
+  {
+    const std::vector<float> ofDate = [&] {
+      engine.updatePose(poses[2]);
+      engine.computeFrame(jd);
+      return sortedByHip(engine.ringBuffer().readSpan());
+    }();
+    config.apparentPlaces = true;
+    engine.setConfig(config);
+    const std::size_t count = engine.computeFrame(jd);
+
+    const astro::transform::ApparentFrame frame = astro::transform::apparentFrame(jd);
+    const double lst = astro::time::localSiderealTimeRad(jd, observer.lonDeg) + frame.equationOfEquinoxesRad;
+    const astro::Mat3 toENU = astro::transform::equatorialToENUMatrix(lst, observer.latDeg);
+    const auto orientation = astro::Quaternion::fromPose(poses[2]);
+    expected.clear();
+    for (const auto& star : grid) {
+      const astro::Vec3 apparent = astro::normalize(
+          frame.biasPrecessionNutation * astro::vector::equatorialToUnit(star.raDeg, star.decDeg) + frame.aberration);
+      const astro::Vec3 enu = toENU * apparent;
+      astro::Horizontal horizontal{std::asin(enu.z), std::atan2(enu.x, enu.y)};
+      horizontal.altRad =
+          astro::transform::applyRefraction(horizontal.altRad, astro::transform::refractionFactor(observer));
+      const astro::Vec3 device = astro::vector::rotateToDevice(astro::vector::horizontalToENU(horizontal), orientation);
+      float x = 0.0f;
+      float y = 0.0f;
+      if (horizontal.altRad > 0.0 && astro::vector::projectToScreen(device, config, x, y)) {
+        expected.insert(expected.end(), {x, y, static_cast<float>(star.mag), static_cast<float>(star.hip)});
+      }
+    }
+    assert(count > 0 && count == expected.size() / 4);
+    const auto apparentFrame = sortedByHip(engine.ringBuffer().readSpan());
+    expected = sortedByHip(expected);
+    float moved = 0.0f;
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+      // Aberration is folded in to first order around the view axis, which
+      // costs up to 0.05 px in the screen corners.
+      assert(std::fabs(apparentFrame[i] - expected[i]) < 0.1f);
+      if (i < ofDate.size() && i % 4 == 0 && ofDate[i + 3] == apparentFrame[i + 3]) {
+        moved = std::max(moved, std::hypot(ofDate[i] - apparentFrame[i], ofDate[i + 1] - apparentFrame[i + 1]));
+      }
+    }
+    assert(moved > 2.0f);
+
+    // Switching off restores the frame of date exactly.
+    config.apparentPlaces = false;
+    engine.setConfig(config);
+    engine.computeFrame(jd);
+    const auto restored = sortedByHip(engine.ringBuffer().readSpan());
+    assert(restored == ofDate);
+  }
+
+  // The fused pose + frame call matches updatePose followed by computeFrame.
+  {
+    engine.updatePose(poses[0]);
+    const std::size_t count = engine.computeFrame(jd);
+    const auto separate = engine.ringBuffer().readSpan();
+    const std::vector<float> expectedFrame(separate.begin(), separate.end());
+
+    engine.updatePose(poses[1]);
+    const std::size_t fusedCount = engine.computeFrame(jd, poses[0]);
+    assert(fusedCount == count);
+    const auto fused = engine.ringBuffer().readSpan();
+    assert(fused.size() == expectedFrame.size());
+    assert(std::memcmp(fused.data(), expectedFrame.data(), expectedFrame.size() * sizeof(float)) == 0);
+  }
+
+  // A worker pool must reproduce the serial frame byte for byte.
+  config.applyRefraction = true;
+  config.workerThreads = 1;
+  engine.setConfig(config);
+  engine.updatePose(poses[2]);
+  const std::size_t serialCount = engine.computeFrame(jd);
+  const auto serialFrame = engine.ringBuffer().readSpan();
+  const std::vector<float> serial(serialFrame.begin(), serialFrame.end());
+
+  config.workerThreads = 4;
+  engine.setConfig(config);
+  for (int frame = 0; frame < 3; ++frame) {
+    const std::size_t parallelCount = engine.computeFrame(jd);
+    assert(parallelCount == serialCount);
+    const auto parallel = engine.ringBuffer().readSpan();
+    assert(std::memcmp(parallel.data(), serial.data(), serial.size() * sizeof(float)) == 0);
+  }
+
   return 0;
 }
@@ -0,0 +1,233 @@
+#include "FrameFormat.hpp"
+#include "RingBuffer.hpp"
+#include "astro/engine.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+template <typename T>
+T load(const std::uint8_t* column, std::size_t index) {
+  T value;
+  std::memcpy(&value, column + index * sizeof(T), sizeof(T));
+  return value;
+}
+
+struct Decoded {
+  float x;
+  float y;
+  float mag;
+  std::uint32_t id;
+};
+
+// Reads the latest frame back as floats, whatever its format.
+std::vector<Decoded> decodeFrame(astro::RingBuffer& buffer) {
+  const auto frame = buffer.acquire();
+  const auto header = buffer.header(frame.slot);
+  const std::uint8_t* slot = buffer.slotBytes(frame.slot);
+  const std::uint8_t* positions = slot + sizeof(astro::RingBuffer::FrameHeader);
+  const std::uint8_t* mags = slot + static_cast<std::size_t>(header.columnOffset[0]);
+  const std::uint8_t* ids = slot + static_cast<std::size_t>(header.columnOffset[1]);
+  const auto format = static_cast<astro::FrameFormat>(header.format);
+
+  std::vector<Decoded> stars(frame.count);
+  for (std::size_t i = 0; i < frame.count; ++i) {
+    switch (format) {
+      case astro::FrameFormat::Float32:
+        stars[i] = {frame.data[i * 4],
+                    frame.data[i * 4 + 1],
+                    frame.data[i * 4 + 2],
+                    static_cast<std::uint32_t>(frame.data[i * 4 + 3])};
+        break;
+      case astro::FrameFormat::Fixed16:
+        stars[i] = {load<std::int16_t>(positions, 2 * i) / astro::kFixedSubpixels,
+                    load<std::int16_t>(positions, 2 * i + 1) / astro::kFixedSubpixels,
+                    load<std::uint8_t>(mags, i) / astro::kFixedMagSteps + astro::kFixedMagOffset,
+                    load<std::uint32_t>(ids, i)};
+        break;
+      case astro::FrameFormat::Half:
+        stars[i] = {astro::halfToFloat(load<std::uint16_t>(positions, 2 * i)),
+                    astro::halfToFloat(load<std::uint16_t>(positions, 2 * i + 1)),
+                    astro::halfToFloat(load<std::uint16_t>(mags, i)),
+                    load<std::uint32_t>(ids, i)};
+        break;
+      case astro::FrameFormat::Vertex:
+        stars[i] = {
+            load<float>(positions, 4 * i), load<float>(positions, 4 * i + 1), NAN, load<std::uint32_t>(mags, i)};
+        break;
+    }
+  }
+  buffer.release(frame.slot);
+  return stars;
+}
+
+}  // namespace
+
+int main() {
+  // binary16 conversion rounds to nearest even and saturates to infinity.
+  assert(astro::floatToHalf(0.0f) == 0x0000 && astro::floatToHalf(-0.0f) == 0x8000);
+  assert(astro::floatToHalf(1.0f) == 0x3C00 && astro::floatToHalf(-2.0f) == 0xC000);
+  assert(astro::floatToHalf(65504.0f) == 0x7BFF && astro::floatToHalf(65520.0f) == 0x7C00);
+  assert(astro::floatToHalf(2049.0f) == 0x6800 && astro::floatToHalf(2051.0f) == 0x6802);
+  assert(astro::floatToHalf(std::ldexp(1.0f, -24)) == 0x0001);
+  assert(astro::floatToHalf(INFINITY) == 0x7C00 && astro::floatToHalf(NAN) == 0x7E00);
+  for (std::uint32_t half = 0; half < 0x10000; ++half) {
+    const float value = astro::halfToFloat(static_cast<std::uint16_t>(half));
+    assert(std::isnan(value) || astro::floatToHalf(value) == half);
+  }
+
+  // Ids past 2^24 do not survive a trip through float.
+  constexpr int kFirstHip = (1 << 24) + 1;
+  std::vector<astro::StarIn> grid;
+  int hip = kFirstHip;
+  for (double dec = -88.0; dec <= 88.0; dec += 2.0) {
+    for (double ra = 0.0; ra < 360.0; ra += 2.0) {
+      grid.push_back({ra, dec, (hip % 80) * 0.1 - 1.0, hip});
+      hip += 1;
+    }
+  }
+  astro::EngineConfig config{};
+  config.screen.width = 1080;
+  config.screen.height = 1920;
+  config.fovDeg = 90.0;
+  astro::AstroEngine engine;
+  engine.setConfig(config);
+  engine.setObserver({37.7749, -122.4194, 0.0});
+  engine.setStars(grid);
+  engine.updatePose({0.9238795, 0.3826834, 0.0, 0.0});
+  const double jd = 2460000.5;
+
+  const std::size_t visible = engine.computeFrame(jd);
+  assert(visible > 100);
+  const std::vector<Decoded> reference = decodeFrame(engine.ringBuffer());
+
+  for (const auto format : {astro::FrameFormat::Fixed16, astro::FrameFormat::Half}) {
+    config.frameFormat = format;
+    engine.setConfig(config);
+    const std::size_t count = engine.computeFrame(jd);
+    assert(count == visible);
+    const std::vector<Decoded> stars = decodeFrame(engine.ringBuffer());
+    assert(stars.size() == visible);
+    bool roundedIds = false;
+    for (std::size_t i = 0; i < visible; ++i) {
+      const Decoded& expected = reference[i];
+      if (format == astro::FrameFormat::Fixed16) {
+        assert(std::fabs(stars[i].x - expected.x) <= 0.5f / astro::kFixedSubpixels);
+        assert(std::fabs(stars[i].y - expected.y) <= 0.5f / astro::kFixedSubpixels);
+        assert(std::fabs(stars[i].mag - expected.mag) <= 0.5f / astro::kFixedMagSteps);
+      } else {
+        assert(std::fabs(stars[i].x - expected.x) <= expected.x * 0x1p-11f);
+        assert(std::fabs(stars[i].y - expected.y) <= expected.y * 0x1p-11f);
+        assert(std::fabs(stars[i].mag - expected.mag) <= 0x1p-8f);
+      }
+      assert(stars[i].id >= static_cast<std::uint32_t>(kFirstHip) && stars[i].id < static_cast<std::uint32_t>(hip));
+      assert(static_cast<std::uint32_t>(static_cast<float>(stars[i].id)) == expected.id);
+      roundedIds = roundedIds || stars[i].id != expected.id;
+    }
+    assert(roundedIds);
+  }
+
+  // Vertex frames keep exact positions and ids; size, alpha and color follow
+  // the point style and each star's B-V.
+  assert(astro::starColor(NAN, 1.0f) == 0xFFFFFFFFu);
+  assert(astro::starColor(0.0f, 0.0f) >> 24 == 0);
+  const std::uint32_t blue = astro::starColor(-0.3f, 1.0f);
+  const std::uint32_t red = astro::starColor(1.8f, 1.0f);
+  assert((blue >> 16 & 0xFF) > (blue & 0xFF) && (red & 0xFF) > (red >> 16 & 0xFF));
+  std::vector<float> colors(grid.size());
+  for (std::size_t i = 0; i < colors.size(); ++i) {
+    colors[i] = i % 3 == 0 ? NAN : -0.4f + static_cast<float>(i % 25) * 0.1f;
+  }
+  const bool colored = engine.setStarColors(0, colors);
+  const bool pastEnd = engine.setStarColors(grid.size(), colors);
+  assert(colored && !pastEnd);
+  assert(engine.starCount() == grid.size());
+  config.frameFormat = astro::FrameFormat::Vertex;
+  config.pointStyle = {5.0, 1.0, 1.5, 6.0, 0.9, 0.125, 0.25};
+  engine.setConfig(config);
+  const std::size_t vertexCount = engine.computeFrame(jd);
+  assert(vertexCount == visible);
+  {
+    const std::vector<Decoded> stars = decodeFrame(engine.ringBuffer());
+    auto& buffer = engine.ringBuffer();
+    const auto frame = buffer.acquire();
+    const std::uint8_t* vertices = buffer.slotBytes(frame.slot) + sizeof(astro::RingBuffer::FrameHeader);
+    for (std::size_t i = 0; i < visible; ++i) {
+      assert(stars[i].x == reference[i].x && stars[i].y == reference[i].y);
+      assert(static_cast<std::uint32_t>(static_cast<float>(stars[i].id)) == reference[i].id);
+      const std::size_t input = stars[i].id - static_cast<std::uint32_t>(kFirstHip);
+      const auto mag = static_cast<float>(grid[input].mag);
+      const float alpha = std::clamp(0.9f - 0.125f * mag, 0.25f, 1.0f);
+      assert(load<float>(vertices, 4 * i + 2) == std::clamp(5.0f - 1.0f * mag, 1.5f, 6.0f));
+      assert(load<std::uint32_t>(vertices, 4 * i + 3) == astro::starColor(colors[input], alpha));
+    }
+    buffer.release(frame.slot);
+  }
+
+  // Switching back serves float records again.
+  config.frameFormat = astro::FrameFormat::Float32;
+  engine.setConfig(config);
+  const std::size_t againCount = engine.computeFrame(jd);
+  assert(againCount == visible);
+  const std::vector<Decoded> again = decodeFrame(engine.ringBuffer());
+  assert(std::memcmp(again.data(), reference.data(), visible * sizeof(Decoded)) == 0);
+
+  // Magnitude patches, packed or StarIn[] without a B-V, keep the colors
+  // already set. Small ids, so packed records carry them exactly.
+  {
+    std::vector<astro::StarIn> small;
+    for (std::size_t i = 0; i < grid.size(); i += 7) {
+      small.push_back({grid[i].raDeg, grid[i].decDeg, grid[i].mag, static_cast<int>(small.size()) + 1});
+    }
+    std::vector<float> smallColors(small.size());
+    for (std::size_t i = 0; i < smallColors.size(); ++i) {
+      smallColors[i] = -0.3f + static_cast<float>(i % 20) * 0.1f;
+    }
+    astro::AstroEngine patched;
+    config.frameFormat = astro::FrameFormat::Vertex;
+    patched.setConfig(config);
+    patched.setObserver({37.7749, -122.4194, 0.0});
+    patched.setStars(small);
+    patched.updatePose({0.9238795, 0.3826834, 0.0, 0.0});
+    const bool smallColored = patched.setStarColors(0, smallColors);
+    assert(smallColored);
+
+    const std::size_t half = small.size() / 2;
+    std::vector<float> records;
+    for (std::size_t i = 0; i < half; ++i) {
+      small[i].mag -= 0.5;
+      records.insert(records.end(),
+                     {static_cast<float>(small[i].raDeg), static_cast<float>(small[i].decDeg),
+                      static_cast<float>(small[i].mag), static_cast<float>(small[i].hip)});
+    }
+    for (std::size_t i = half; i < small.size(); ++i) {
+      small[i].mag -= 0.5;
+    }
+    const bool packedPatched = patched.updatePackedStars(0, records);
+    const bool starsPatched =
+        patched.updateStars(half, std::span<const astro::StarIn>(small.data() + half, small.size() - half));
+    assert(packedPatched && starsPatched);
+
+    const std::size_t count = patched.computeFrame(jd);
+    assert(count > 10);
+    auto& buffer = patched.ringBuffer();
+    const auto frame = buffer.acquire();
+    const std::uint8_t* slot = buffer.slotBytes(frame.slot);
+    const std::uint8_t* vertices = slot + sizeof(astro::RingBuffer::FrameHeader);
+    const std::uint8_t* ids = slot + static_cast<std::size_t>(buffer.header(frame.slot).columnOffset[0]);
+    for (std::size_t i = 0; i < count; ++i) {
+      const std::size_t input = load<std::uint32_t>(ids, i) - 1;
+      const auto mag = static_cast<float>(small[input].mag);
+      const float alpha = std::clamp(0.9f - 0.125f * mag, 0.25f, 1.0f);
+      assert(load<float>(vertices, 4 * i + 2) == std::clamp(5.0f - 1.0f * mag, 1.5f, 6.0f));
+      assert(load<std::uint32_t>(vertices, 4 * i + 3) == astro::starColor(smallColors[input], alpha));
+    }
+    buffer.release(frame.slot);
+  }
+  return 0;
+}
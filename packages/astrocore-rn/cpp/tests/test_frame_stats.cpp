@@ -0,0 +1,110 @@
+#include "astro/FrameStats.hpp"
+#include "astro/engine.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace {
+
+std::size_t stage(astro::FrameStage s) {
+  return static_cast<std::size_t>(s);
+}
+
+std::size_t counter(astro::FrameCounter c) {
+  return static_cast<std::size_t>(c);
+}
+
+}  // namespace
+
+int main() {
+  // Percentiles are nearest-rank over the latest window of frames.
+  astro::FrameStatsRecorder recorder;
+  assert(recorder.snapshot().frames == 0);
+  for (int i = 1; i <= 100; ++i) {
+    astro::FrameSample sample;
+    sample.stageMicros[stage(astro::FrameStage::Project)] = static_cast<float>(i);
+    sample.stageMicros[stage(astro::FrameStage::Commit)] = 1.0f;
+    sample.counters[counter(astro::FrameCounter::Emitted)] = static_cast<std::uint32_t>(101 - i);
+    recorder.record(sample);
+  }
+  astro::FrameStats stats = recorder.snapshot();
+  assert(stats.frames == 100 && stats.window == 100);
+  assert(stats.stageMicros[stage(astro::FrameStage::Project)].p50 == 50.0);
+  assert(stats.stageMicros[stage(astro::FrameStage::Project)].p95 == 95.0);
+  assert(stats.stageMicros[stage(astro::FrameStage::Project)].p99 == 99.0);
+  assert(stats.stageMicros[stage(astro::FrameStage::Total)].p99 == 100.0);
+  assert(stats.counters[counter(astro::FrameCounter::Emitted)].p50 == 50.0);
+  assert(stats.last.counters[counter(astro::FrameCounter::Emitted)] == 1);
+
+  // Older frames roll out of the window.
+  for (std::size_t i = 0; i < astro::FrameStatsRecorder::kWindow; ++i) {
+    recorder.record({});
+  }
+  stats = recorder.snapshot();
+  assert(stats.frames == 100 + astro::FrameStatsRecorder::kWindow);
+  assert(stats.window == astro::FrameStatsRecorder::kWindow);
+  assert(stats.stageMicros[stage(astro::FrameStage::Total)].p99 == 0.0);
+  recorder.reset();
+  assert(recorder.snapshot().frames == 0);
+
+  std::vector<astro::StarIn> grid;
+  int hip = 1;
+  for (double dec = -88.0; dec <= 88.0; dec += 2.0) {
+    for (double ra = 0.0; ra < 360.0; ra += 2.0) {
+      grid.push_back({ra, dec, (hip % 80) * 0.1, hip});
+      hip += 1;
+    }
+  }
+  astro::EngineConfig config{};
+  config.screen.width = 1080;
+  config.screen.height = 1920;
+  astro::AstroEngine engine;
+  engine.setConfig(config);
+  engine.setObserver({37.7749, -122.4194, 0.0});
+  astro::CatalogOptions unsorted;
+  unsorted.sortByMagnitude = false;
+  engine.setStars(grid, unsorted);
+  engine.updatePose({0.9238795, 0.3826834, 0.0, 0.0});
+  const double jd = 2460000.5;
+
+  // Nothing is recorded unless asked for.
+  engine.computeFrame(jd);
+  assert(engine.frameStats().frames == 0);
+
+  config.recordFrameStats = true;
+  config.limitingMag = 5.0;
+  engine.setConfig(config);
+  const std::size_t visible = engine.computeFrame(jd);
+  stats = engine.frameStats();
+  if (!astro::kFrameStatsCompiled) {
+    assert(stats.frames == 0);
+    return 0;
+  }
+  assert(stats.frames == 1);
+  const auto counts = stats.last.counters;
+  assert(counts[counter(astro::FrameCounter::Emitted)] == visible);
+  assert(counts[counter(astro::FrameCounter::TileCulled)] > 0);
+  assert(counts[counter(astro::FrameCounter::Faint)] > 0);
+  std::size_t total = 0;
+  for (std::uint32_t count : counts) {
+    total += count;
+  }
+  assert(total == grid.size());
+  assert(stats.last.stageMicros[stage(astro::FrameStage::Total)] > 0.0f);
+
+  // Worker slices count into their own totals, which add up to the serial ones.
+  config.workerThreads = 4;
+  engine.setConfig(config);
+  const std::size_t parallelVisible = engine.computeFrame(jd);
+  assert(parallelVisible == visible);
+  stats = engine.frameStats();
+  assert(stats.frames == 2);
+  for (std::size_t c = 0; c < astro::kFrameCounterCount; ++c) {
+    assert(stats.last.counters[c] == counts[c]);
+  }
+
+  engine.resetFrameStats();
+  assert(engine.frameStats().frames == 0);
+  return 0;
+}
@@ -0,0 +1,126 @@
+#include "RingBuffer.hpp"
+#include "astro/PoseHistory.hpp"
+#include "astro/engine.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// Poses turning about the device z axis.
+astro::PoseQuat turned(double angleRad) {
+  return {std::cos(angleRad / 2.0), 0.0, 0.0, std::sin(angleRad / 2.0)};
+}
+
+double angleOf(const astro::PoseQuat& pose) {
+  assert(std::fabs(pose.x) < 1e-12 && std::fabs(pose.y) < 1e-12);
+  // q and -q are the same rotation.
+  return pose.w < 0.0 ? 2.0 * std::atan2(-pose.z, -pose.w) : 2.0 * std::atan2(pose.z, pose.w);
+}
+
+bool near(double a, double b) {
+  return std::fabs(a - b) < 1e-9;
+}
+
+std::vector<float> latestFrame(const astro::AstroEngine& engine) {
+  const auto span = engine.ringBuffer().readSpan();
+  return {span.begin(), span.end()};
+}
+
+}  // namespace
+
+int main() {
+  astro::PoseHistory history;
+  astro::PoseQuat pose;
+  assert(!history.poseAt(0.0, 50.0, pose));
+
+  // 0.01 rad per ms. The middle sample is stored in the other hemisphere.
+  history.push(1000.0, turned(0.0));
+  history.push(1010.0, turned(0.1));
+  const astro::PoseQuat flipped = turned(0.2);
+  history.push(1020.0, {-flipped.w, -flipped.x, -flipped.y, -flipped.z});
+  history.push(1030.0, turned(0.3));
+  assert(history.size() == 4);
+
+  // Interpolated inside, held before the first sample, extrapolated ahead
+  // up to the lead limit.
+  assert(history.poseAt(1005.0, 50.0, pose) && near(angleOf(pose), 0.05));
+  assert(history.poseAt(1015.0, 50.0, pose) && near(angleOf(pose), 0.15));
+  assert(history.poseAt(1030.0, 50.0, pose) && near(angleOf(pose), 0.3));
+  assert(history.poseAt(900.0, 50.0, pose) && near(angleOf(pose), 0.0));
+  assert(history.poseAt(1046.0, 50.0, pose) && near(angleOf(pose), 0.46));
+  assert(history.poseAt(2000.0, 50.0, pose) && near(angleOf(pose), 0.8));
+  assert(history.poseAt(2000.0, 0.0, pose) && near(angleOf(pose), 0.3));
+
+  // Late samples are dropped; a repeated timestamp replaces the newest.
+  history.push(1025.0, turned(1.0));
+  history.push(1030.0, turned(0.35));
+  assert(history.size() == 4);
+  assert(history.poseAt(1030.0, 50.0, pose) && near(angleOf(pose), 0.35));
+
+  // Only the latest kCapacity samples are kept.
+  history.clear();
+  for (std::size_t i = 0; i < astro::PoseHistory::kCapacity + 8; ++i) {
+    history.push(static_cast<double>(i), turned(0.01 * static_cast<double>(i)));
+  }
+  assert(history.size() == astro::PoseHistory::kCapacity);
+  assert(history.poseAt(0.0, 50.0, pose) && near(angleOf(pose), 0.08));
+
+  // The engine draws the predicted pose, and forgets the history on updatePose.
+  std::vector<astro::StarIn> grid;
+  int hip = 1;
+  for (double dec = -85.0; dec <= 85.0; dec += 5.0) {
+    for (double ra = 0.0; ra < 360.0; ra += 5.0) {
+      grid.push_back({ra, dec, 1.0 + (hip % 60) * 0.1, hip});
+      hip += 1;
+    }
+  }
+  astro::EngineConfig config{};
+  config.screen.width = 1080;
+  config.screen.height = 1920;
+  astro::AstroEngine engine;
+  engine.setConfig(config);
+  engine.setObserver({37.7749, -122.4194, 0.0});
+  engine.setStars(grid);
+  const double jd = 2460000.5;
+
+  engine.pushPose(1000.0, turned(0.5));
+  engine.pushPose(1010.0, turned(0.6));
+  const std::size_t predicted = engine.computeFrame(jd, 1030.0);
+  const std::vector<float> predictedFrame = latestFrame(engine);
+  assert(predicted > 0);
+  history.clear();
+  history.push(1000.0, turned(0.5));
+  history.push(1010.0, turned(0.6));
+  const bool sampled = history.poseAt(1030.0, config.maxPoseLeadMs, pose);
+  assert(sampled);
+  const std::size_t resampled = engine.computeFrame(jd, pose);
+  assert(resampled == predicted);
+  assert(std::memcmp(latestFrame(engine).data(), predictedFrame.data(), predictedFrame.size() * sizeof(float)) == 0);
+
+  engine.updatePose(turned(0.6));
+  const std::size_t latest = engine.computeFrame(jd);
+  const std::vector<float> latestPose = latestFrame(engine);
+  const std::size_t unpredicted = engine.computeFrame(jd, 1030.0);
+  assert(unpredicted == latest);
+  assert(std::memcmp(latestFrame(engine).data(), latestPose.data(), latestPose.size() * sizeof(float)) == 0);
+
+  // A batch feeds every sample to the history and draws the newest at its
+  // own time; a single fused pose forgets the history again.
+  const astro::PoseQuat first = turned(0.5);
+  const astro::PoseQuat second = turned(0.6);
+  const std::vector<double> batch = {1000.0, first.w,  first.x,  first.y,  first.z,
+                                     1010.0, second.w, second.x, second.y, second.z};
+  const std::size_t batched = engine.computeFrame(batch);
+  assert(batched > 0);
+  const std::size_t fromBatch = engine.computeFrame(jd, 1030.0);
+  assert(fromBatch == predicted);
+  assert(std::memcmp(latestFrame(engine).data(), predictedFrame.data(), predictedFrame.size() * sizeof(float)) == 0);
+  const std::size_t fused = engine.computeFrame(jd, second);
+  const std::size_t afterFused = engine.computeFrame(jd, 1030.0);
+  assert(fused == latest && afterFused == latest);
+  assert(std::memcmp(latestFrame(engine).data(), latestPose.data(), latestPose.size() * sizeof(float)) == 0);
+  return 0;
+}
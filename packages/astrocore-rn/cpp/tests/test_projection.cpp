@@ -0,0 +1,131 @@
+#include "ProjectionKernel.hpp"
+#include "astro/catalog.hpp"
+#include "astro/transform.hpp"
+#include "astro/vector.hpp"
+
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+astro::ProjectionParams makeParams(const astro::Mat3& toENU,
+                                   const astro::Mat3& toDevice,
+                                   const astro::transform::RefractionTable* refraction) {
+  const astro::Mat3 combined = toDevice * toENU;
+  const astro::Vec3 zenith = toENU.row(2);
+  const astro::Vec3 deviceUp = toDevice.column(2);
+
+  astro::ProjectionParams params{};
+  for (int r = 0; r < 3; ++r) {
+    for (int c = 0; c < 3; ++c) {
+      params.toDevice[r][c] = static_cast<float>(combined.m[r][c]);
+    }
+  }
+  params.zenith[0] = static_cast<float>(zenith.x);
+  params.zenith[1] = static_cast<float>(zenith.y);
+  params.zenith[2] = static_cast<float>(zenith.z);
+  params.deviceUp[0] = static_cast<float>(deviceUp.x);
+  params.deviceUp[1] = static_cast<float>(deviceUp.y);
+  params.deviceUp[2] = static_cast<float>(deviceUp.z);
+  params.halfWidth = 540.0f;
+  params.halfHeight = 960.0f;
+  params.focalLength = 935.3f;
+  params.width = 1080.0f;
+  params.height = 1920.0f;
+  params.refraction = refraction;
+  return params;
+}
+
+}  // namespace
+
+int main() {
+  // A dense, irregular sky so every lane pattern and the scalar tail are hit.
+  std::vector<astro::StarIn> stars;
+  for (int i = 0; i < 20011; ++i) {
+    const double ra = static_cast<double>((i * 7919) % 36000) * 0.01;
+    const double dec = static_cast<double>((i * 104729) % 17800) * 0.01 - 89.0;
+    stars.push_back({ra, dec, (i % 70) * 0.1, i + 1});
+  }
+  astro::StarCatalog catalog;
+  catalog.assign(stars);
+  const astro::CatalogColumns columns{catalog.x(), catalog.y(), catalog.z(), catalog.mag(), catalog.hip()};
+
+  const astro::ProjectionKernelInfo* kernels[8];
+  const std::size_t kernelCount = astro::availableProjectionKernels(kernels, 8);
+  assert(kernelCount >= 1);
+  assert(kernels[0]->kernel == astro::projectStarsScalar);
+  assert(astro::selectProjectionKernel().kernel == kernels[kernelCount - 1]->kernel);
+#if defined(ASTRO_HAVE_X86_KERNELS)
+  // The comparisons below cover the 16-lane kernel wherever the CPU has it.
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    assert(kernels[kernelCount - 1]->kernel == astro::projectStarsAvx512 && kernels[kernelCount - 1]->lanes == 16);
+  }
+#endif
+
+  const astro::Mat3 toENU = astro::transform::equatorialToENUMatrix(2.1, 48.0);
+  const astro::Mat3 toDevice = astro::Quaternion(0.9, 0.3, -0.2, 0.1).toMatrix();
+  const astro::transform::RefractionTable refraction(1.1);
+
+  for (int variant = 0; variant < 4; ++variant) {
+    astro::ProjectionParams params = makeParams(toENU, toDevice, variant != 0 ? &refraction : nullptr);
+    if (variant == 2) {
+      params.limitingMag = 3.05f;
+      params.filterMagnitude = true;
+    }
+    params.rawIds = variant == 3;
+
+    // Odd ranges and a tight capacity exercise the tail and the capacity stop.
+    for (std::size_t capacity : {std::size_t{65536}, std::size_t{37}}) {
+      std::vector<float> expected(capacity * 4, -1.0f);
+      const std::size_t expectedCount =
+          astro::projectStarsScalar(params, columns, 3, catalog.size() - 5, expected.data(), capacity);
+      assert(expectedCount > 0);
+      assert(expectedCount <= capacity);
+      if (params.rawIds) {
+        for (std::size_t i = 0; i < expectedCount; ++i) {
+          const auto hip = std::bit_cast<std::int32_t>(expected[i * 4 + 3]);
+          assert(hip >= 1 && hip <= static_cast<std::int32_t>(stars.size()));
+        }
+      }
+
+      for (std::size_t k = 0; k < kernelCount; ++k) {
+        std::vector<float> actual(capacity * 4, -1.0f);
+        const std::size_t count =
+            kernels[k]->kernel(params, columns, 3, catalog.size() - 5, actual.data(), capacity);
+        assert(count == expectedCount);
+        assert(std::memcmp(actual.data(), expected.data(), count * 4 * sizeof(float)) == 0);
+      }
+    }
+
+    // Every kernel attributes each rejected star to the same first failed
+    // test, and together with the emitted stars they cover the range.
+    if (astro::kFrameStatsCompiled) {
+      std::vector<float> scratch(65536 * 4);
+      astro::CullCounters expected;
+      params.counters = &expected;
+      const std::size_t begin = 3;
+      const std::size_t end = catalog.size() - 5;
+      const std::size_t emitted = astro::projectStarsScalar(params, columns, begin, end, scratch.data(), 65536);
+      assert(expected.faint + expected.belowHorizon + expected.behindCamera + expected.offScreen + emitted ==
+             end - begin);
+      assert(expected.belowHorizon > 0 && expected.behindCamera > 0 && expected.offScreen > 0);
+      assert((expected.faint > 0) == (variant == 2));
+      for (std::size_t k = 0; k < kernelCount; ++k) {
+        astro::CullCounters culled;
+        params.counters = &culled;
+        assert(kernels[k]->kernel(params, columns, begin, end, scratch.data(), 65536) == emitted);
+        assert(culled.faint == expected.faint);
+        assert(culled.belowHorizon == expected.belowHorizon);
+        assert(culled.behindCamera == expected.behindCamera);
+        assert(culled.offScreen == expected.offScreen);
+      }
+      params.counters = nullptr;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,125 @@
+#include "RingBuffer.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <thread>
+
+int main() {
+  astro::RingBuffer buffer;
+  buffer.configure(4, 16);
+  assert(buffer.slotCount() == astro::RingBuffer::kDefaultSlots);
+  const auto none = buffer.acquire();
+  assert(none.slot == astro::RingBuffer::kNoSlot);
+  assert(buffer.count() == 0);
+
+  // Published frames carry increasing sequence numbers.
+  buffer.writePtr()[0] = 1.0f;
+  buffer.commit(3, 2460000.25);
+  const auto first = buffer.acquire();
+  assert(first.slot != astro::RingBuffer::kNoSlot);
+  assert(first.sequence == 1);
+  assert(first.count == 3);
+  assert(first.data[0] == 1.0f);
+
+  // The slot's header describes the frame, and the records follow it.
+  const auto header = buffer.header(first.slot);
+  assert(header.sequence == 1.0);
+  assert(header.julianDate == 2460000.25);
+  assert(header.count == 3.0);
+  assert(header.slot == first.slot);
+  assert(header.format == 0.0 && header.capacity == 16.0);
+  assert(header.columnOffset[0] == 0.0 && header.columnOffset[1] == 0.0);
+  assert(first.data == buffer.slotData(first.slot));
+  assert(reinterpret_cast<const std::uint8_t*>(first.data) ==
+         buffer.slotBytes(first.slot) + sizeof(astro::RingBuffer::FrameHeader));
+  assert(buffer.byteLength() == sizeof(astro::RingBuffer::FrameHeader) + 4 * 16 * sizeof(float));
+
+  // A pinned slot is never handed back to the producer.
+  for (int frame = 0; frame < 10; ++frame) {
+    float* out = buffer.writePtr();
+    assert(out != nullptr);
+    assert(out != first.data);
+    out[0] = 2.0f;
+    buffer.commit(100);
+  }
+  assert(first.data[0] == 1.0f);
+  assert(buffer.sequence() == 11);
+  assert(buffer.count() == 16);
+
+  // With every other slot pinned the producer has nowhere to write.
+  astro::RingBuffer::Frame pins[astro::RingBuffer::kDefaultSlots];
+  pins[0] = first;
+  for (std::size_t p = 1; p < buffer.slotCount() - 1; ++p) {
+    buffer.writePtr();
+    buffer.commit(1);
+    pins[p] = buffer.acquire();
+  }
+  buffer.commit(1);
+  const float* full = buffer.writePtr();
+  assert(full == nullptr);
+  const std::uint64_t stalled = buffer.sequence();
+  buffer.commit(1);
+  assert(buffer.sequence() == stalled);
+  for (std::size_t p = 0; p < buffer.slotCount() - 1; ++p) {
+    buffer.release(pins[p].slot);
+  }
+  const float* freed = buffer.writePtr();
+  assert(freed != nullptr);
+
+  // Narrower columns pack into the same slots, each on its own cache line,
+  // and every frame's header records the layout it was written with.
+  const bool oversized = buffer.setLayout({1, {4 * sizeof(float), 1, 0}});
+  assert(!oversized);
+  assert(buffer.layout().format == 0);
+  const bool packedLayout = buffer.setLayout({7, {4, 1, 4}});
+  assert(packedLayout);
+  assert(buffer.columnOffset(0) == sizeof(astro::RingBuffer::FrameHeader));
+  assert(buffer.columnOffset(1) == 64 + 64 && buffer.columnOffset(2) == 128 + 64);
+  std::uint8_t* positions = buffer.writeColumn(0);
+  assert(positions == reinterpret_cast<std::uint8_t*>(buffer.writePtr()));
+  buffer.writeColumn(2)[0] = 42;
+  buffer.commit(16);
+  const auto packed = buffer.acquire();
+  const auto packedHeader = buffer.header(packed.slot);
+  assert(packedHeader.format == 7.0);
+  assert(packedHeader.columnOffset[0] == 128.0 && packedHeader.columnOffset[1] == 192.0);
+  assert(buffer.slotBytes(packed.slot)[192] == 42);
+  buffer.release(packed.slot);
+
+  // A consumer on another thread never sees a torn or reused frame: every
+  // value in a pinned slot matches its sequence number, and sequences only
+  // move forward.
+  constexpr std::uint64_t kFrames = 20000;
+  astro::RingBuffer shared;
+  shared.configure(4, 256);
+  std::thread producer([&shared] {
+    for (std::uint64_t frame = 1; frame <= kFrames;) {
+      float* out = shared.writePtr();
+      if (out == nullptr) {
+        std::this_thread::yield();
+        continue;
+      }
+      for (std::size_t i = 0; i < 4 * 256; ++i) {
+        out[i] = static_cast<float>(frame);
+      }
+      shared.commit(256);
+      frame += 1;
+    }
+  });
+  std::uint64_t lastSequence = 0;
+  while (lastSequence < kFrames) {
+    const auto frame = shared.acquire();
+    if (frame.slot == astro::RingBuffer::kNoSlot) {
+      continue;
+    }
+    assert(frame.sequence >= lastSequence);
+    for (std::size_t i = 0; i < 4 * 256; ++i) {
+      assert(frame.data[i] == static_cast<float>(frame.sequence));
+    }
+    lastSequence = frame.sequence;
+    shared.release(frame.slot);
+  }
+  producer.join();
+
+  return 0;
+}
@@ -0,0 +1,100 @@
+#include "astro/catalog.hpp"
+#include "astro/vector.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+namespace {
+constexpr double kDegToRad = 0.01745329251994329577;
+
+bool inRanges(const std::vector<astro::StarRange>& ranges, std::uint32_t index) {
+  for (const auto& range : ranges) {
+    if (index >= range.begin && index < range.end) {
+      return true;
+    }
+  }
+  return false;
+}
+void checkCollect(const astro::StarCatalog& catalog, double limitingMag, double radiusDeg) {
+  const astro::Vec3 zenith = astro::normalize({0.3, -0.2, 0.9});
+  const astro::SkyCone horizon{zenith, 90.0 * kDegToRad};
+  const astro::Vec3 axis = astro::normalize({0.5, 0.4, 0.2});
+  const astro::SkyCone view{axis, radiusDeg * kDegToRad};
+
+  std::vector<astro::StarRange> ranges;
+  catalog.collect(view, horizon, limitingMag, ranges);
+
+  std::size_t collected = 0;
+  for (std::size_t r = 0; r < ranges.size(); ++r) {
+    assert(ranges[r].begin < ranges[r].end);
+    assert(r == 0 || ranges[r - 1].end < ranges[r].begin);
+    collected += ranges[r].end - ranges[r].begin;
+  }
+
+  for (std::uint32_t i = 0; i < catalog.size(); ++i) {
+    const astro::Vec3 star{catalog.x()[i], catalog.y()[i], catalog.z()[i]};
+    const bool inView = std::acos(astro::dot(star, axis)) <= view.radiusRad;
+    const bool aboveHorizon = std::acos(astro::dot(star, zenith)) <= horizon.radiusRad;
+    const bool bright = catalog.mag()[i] <= limitingMag;
+    if (inView && aboveHorizon && bright) {
+      assert(inRanges(ranges, i));
+    }
+    if (!bright) {
+      assert(!inRanges(ranges, i));
+    }
+  }
+
+  // Narrow views must not degenerate into a full scan.
+  if (radiusDeg <= 20.0) {
+    assert(collected < catalog.size() / 4);
+  }
+}
+
+}  // namespace
+
+int main() {
+  std::vector<astro::StarIn> stars;
+  for (int i = 0; i < 5000; ++i) {
+    const double ra = static_cast<double>((i * 7919) % 36000) * 0.01;
+    const double dec = std::asin(static_cast<double>((i * 104729) % 20000) / 10000.0 - 1.0) / kDegToRad;
+    stars.push_back({ra, dec, (i % 70) * 0.1, i + 1});
+  }
+
+  astro::CatalogOptions options;
+  options.indexLevels = 3;
+  astro::StarCatalog catalog;
+  catalog.assign(stars, options);
+  assert(catalog.size() == stars.size());
+  assert(catalog.sortedByMagnitude());
+
+  // Leaves partition storage in order, and parents cover exactly their children.
+  const astro::SkyIndex& index = catalog.index();
+  assert(index.levels() == 3);
+  for (int l = 0; l <= index.levels(); ++l) {
+    const auto tiles = index.level(l);
+    assert(tiles.size() == (std::size_t{6} << (2 * l)));
+    assert(tiles.front().begin == 0);
+    assert(tiles.back().end == catalog.size());
+    for (std::size_t t = 1; t < tiles.size(); ++t) {
+      assert(tiles[t].begin == tiles[t - 1].end);
+    }
+  }
+
+  // Leaves are ordered brightest first.
+  for (const auto& leaf : index.level(index.levels())) {
+    for (std::uint32_t i = leaf.begin + 1; i < leaf.end; ++i) {
+      assert(catalog.mag()[i - 1] <= catalog.mag()[i]);
+    }
+  }
+
+  // Every star inside the query cones, and no star fainter than the limit,
+  // must come back from collect().
+  for (double limitingMag : {100.0, 3.05}) {
+    for (double radiusDeg : {5.0, 20.0, 60.0, 120.0}) {
+      checkCollect(catalog, limitingMag, radiusDeg);
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,120 @@
+#include "astro/engine.hpp"
+#include "astro/trace.hpp"
+
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::string readFile(const std::string& path) {
+  std::ifstream file(path);
+  std::stringstream contents;
+  contents << file.rdbuf();
+  return contents.str();
+}
+
+std::size_t occurrences(const std::string& text, const std::string& needle) {
+  std::size_t count = 0;
+  for (std::size_t at = text.find(needle); at != std::string::npos; at = text.find(needle, at + 1)) {
+    ++count;
+  }
+  return count;
+}
+
+}  // namespace
+
+int main() {
+  const std::string path = "test_trace.json";
+
+  // Nothing is recorded before start().
+  { astro::trace::Span span("test", "idle"); }
+  bool dumped = astro::trace::dump(path);
+  assert(dumped);
+  std::string json = readFile(path);
+  assert(json.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0) == 0);
+  assert(occurrences(json, "\"ph\":\"X\"") == 0);
+  if (!astro::trace::kCompiled) {
+    std::remove(path.c_str());
+    return 0;
+  }
+
+  std::vector<astro::StarIn> grid;
+  int hip = 1;
+  for (double dec = -88.0; dec <= 88.0; dec += 2.0) {
+    for (double ra = 0.0; ra < 360.0; ra += 2.0) {
+      grid.push_back({ra, dec, (hip % 80) * 0.1, hip});
+      hip += 1;
+    }
+  }
+  astro::EngineConfig config{};
+  config.screen.width = 1080;
+  config.screen.height = 1920;
+  config.fovDeg = 120.0;
+  config.workerThreads = 4;
+  astro::AstroEngine engine;
+  engine.setConfig(config);
+  engine.setObserver({37.7749, -122.4194, 0.0});
+
+  astro::trace::start();
+  engine.setStars(grid);
+  engine.updatePose({0.9238795, 0.3826834, 0.0, 0.0});
+  const std::size_t visible = engine.computeFrame(2460000.5);
+  assert(visible > 0);
+  astro::trace::stop();
+  engine.computeFrame(2460000.6);  // not recorded
+
+  dumped = astro::trace::dump(path);
+  assert(dumped);
+  json = readFile(path);
+  assert(occurrences(json, "\"name\":\"setStars\"") == 1);
+  assert(occurrences(json, "\"name\":\"frame\"") == 1);
+  assert(occurrences(json, "\"name\":\"cull\"") == 1);
+  assert(occurrences(json, "\"name\":\"project\"") == 1);
+  assert(occurrences(json, "\"name\":\"projectSlice\"") > 1);
+  assert(occurrences(json, "\"name\":\"frame\",\"pid\":1") == 1);
+  assert(json.find("\"args\":{\"count\":" + std::to_string(grid.size()) + "}") != std::string::npos);
+  assert(json.find("\"args\":{\"count\":" + std::to_string(visible) + "}") != std::string::npos);
+  assert(json.find("\"args\":{\"name\":\"astro-worker\"}") != std::string::npos);
+
+  // Concurrent writers wrap the ring; the dump keeps the newest events only.
+  // A writer descheduled for a whole lap may cost an event.
+  astro::trace::start();
+  const std::size_t perThread = ASTRO_TRACE_EVENTS;
+  std::vector<std::thread> writers;
+  for (int t = 0; t < 4; ++t) {
+    writers.emplace_back([&] {
+      for (std::size_t i = 0; i < perThread; ++i) {
+        astro::trace::Span span("test", "spin");
+      }
+    });
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+  astro::trace::stop();
+  dumped = astro::trace::dump(path);
+  assert(dumped);
+  json = readFile(path);
+  const std::size_t spins = occurrences(json, "\"name\":\"spin\"");
+  assert(spins <= ASTRO_TRACE_EVENTS && spins + writers.size() >= ASTRO_TRACE_EVENTS);
+  assert(occurrences(json, "\"ph\":\"X\"") == spins);
+  assert(json.size() > 4 && json.compare(json.size() - 4, 4, "\n]}\n") == 0);
+
+  // A fresh session drops what came before.
+  astro::trace::start();
+  { astro::trace::Span span("test", "fresh"); }
+  astro::trace::stop();
+  dumped = astro::trace::dump(path);
+  assert(dumped);
+  json = readFile(path);
+  assert(occurrences(json, "\"ph\":\"X\"") == 1);
+
+  assert(!astro::trace::dump("/nonexistent-dir/trace.json"));
+  std::remove(path.c_str());
+  return 0;
+}
@@ -1,7 +1,11 @@
 #include "astro/transform.hpp"
+#include "astro/vector.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstdint>
+#include <vector>
 
 namespace {
 constexpr double kDegToRad = 0.01745329251994329577;
@@ -25,5 +29,119 @@ int main() {
   const double altRef = astro::transform::applyRefraction(altNoRef);
   assert(altRef > altNoRef);
 
+  // The equatorial->ENU matrix agrees with the spherical-trig path.
+  const auto toENU = astro::transform::equatorialToENUMatrix(1.3, 37.0);
+  for (double decDeg = -60.0; decDeg <= 60.0; decDeg += 30.0) {
+    for (double raDeg = 0.0; raDeg < 360.0; raDeg += 45.0) {
+      const auto expected = astro::vector::horizontalToENU(
+          astro::transform::equatorialToHorizontal(raDeg, decDeg, 1.3, 37.0));
+      const auto actual = toENU * astro::vector::equatorialToUnit(raDeg, decDeg);
+      assert(std::fabs(actual.x - expected.x) < 1e-9);
+      assert(std::fabs(actual.y - expected.y) < 1e-9);
+      assert(std::fabs(actual.z - expected.z) < 1e-9);
+    }
+  }
+
+  // Refraction on a unit vector matches the altitude formula.
+  const auto shift = astro::transform::refractionShift(std::sin(altNoRef));
+  assert(std::fabs(shift.up - std::sin(altRef)) < 1e-12);
+  assert(std::fabs(shift.scale * std::cos(altNoRef) - std::cos(altRef)) < 1e-12);
+
+  // Thinner, warmer air refracts less; default conditions match the formula.
+  astro::Observer observer{};
+  assert(std::fabs(astro::transform::refractionFactor(observer) - 1.0) < 1e-12);
+  observer.elevationM = 4000.0;
+  const double highFactor = astro::transform::refractionFactor(observer);
+  assert(highFactor > 0.6 && highFactor < 0.65);
+  observer.pressureHPa = 1010.0;
+  observer.temperatureC = -20.0;
+  assert(astro::transform::refractionFactor(observer) > 1.1);
+  assert(astro::transform::applyRefraction(altNoRef, highFactor) < altRef);
+
+  // The table tracks the formula to within the documented arcsecond.
+  for (double factor : {0.5, 1.0, 1.3}) {
+    const astro::transform::RefractionTable table(factor);
+    double worstRad = 0.0;
+    for (int i = 0; i <= 200000; ++i) {
+      const float sinAlt = static_cast<float>(-0.03 + 1.03 * i / 200000.0);
+      const auto exact = astro::transform::refractionShift(std::min<double>(sinAlt, 1.0), factor);
+      float scale = 0.0f;
+      float up = 0.0f;
+      table.lookup(sinAlt, scale, up);
+      const double cosAlt = std::sqrt(std::max(0.0, 1.0 - static_cast<double>(sinAlt) * sinAlt));
+      worstRad = std::max(worstRad, std::hypot(up - exact.up, (scale - exact.scale) * cosAlt));
+    }
+    assert(worstRad < 1.0 / 3600.0 * kDegToRad);
+  }
+
+  // The lift table scales with the factor and vanishes below -1 deg.
+  {
+    const astro::transform::RefractionLiftTable lift;
+    for (double altDeg : {-0.5, 0.0, 10.0, 45.0, 89.0}) {
+      const double altRad = altDeg * kDegToRad;
+      const double exact = astro::transform::applyRefraction(altRad, 1.2) - altRad;
+      assert(std::fabs(1.2 * lift.lift(static_cast<float>(std::sin(altRad))) - exact) < 1.0 / 3600.0 * kDegToRad);
+    }
+    assert(lift.lift(static_cast<float>(std::sin(-2.0 * kDegToRad))) == 0.0f);
+  }
+
+  // Batch forms match the one-star forms exactly, and stop at the shortest span.
+  {
+    constexpr std::size_t kCount = 1001;
+    std::vector<double> raDeg(kCount);
+    std::vector<double> decDeg(kCount);
+    for (std::size_t i = 0; i < kCount; ++i) {
+      raDeg[i] = static_cast<double>((i * 7919) % 36000) * 0.01;
+      decDeg[i] = static_cast<double>((i * 104729) % 18000) * 0.01 - 90.0;
+    }
+    std::vector<double> alt(kCount, -9.0);
+    std::vector<double> az(kCount);
+    astro::transform::equatorialToHorizontal(raDeg, decDeg, 1.3, 37.0, alt, std::span<double>(az).first(kCount - 1));
+    assert(alt.back() == -9.0);
+    std::vector<double> refracted(kCount);
+    astro::transform::applyRefraction(alt, refracted, 1.2);
+    std::vector<double> east(kCount);
+    std::vector<double> north(kCount);
+    std::vector<double> up(kCount);
+    astro::vector::horizontalToENU(alt, az, east, north, up);
+
+    astro::EngineConfig config{};
+    config.screen = {1080, 1920};
+    const astro::ScreenProjection projection = astro::vector::makeScreenProjection(config);
+    std::vector<float> screenX(kCount);
+    std::vector<float> screenY(kCount);
+    std::vector<std::uint8_t> visible(kCount);
+    // East/north/up used directly as device axes: the camera looks at the zenith.
+    const std::size_t onScreen =
+        astro::vector::projectToScreen(east, north, up, projection, screenX, screenY, visible);
+    std::size_t expectedOnScreen = 0;
+    for (std::size_t i = 0; i + 1 < kCount; ++i) {
+      const auto horizontal = astro::transform::equatorialToHorizontal(raDeg[i], decDeg[i], 1.3, 37.0);
+      assert(alt[i] == horizontal.altRad && az[i] == horizontal.azRad);
+      assert(refracted[i] == astro::transform::applyRefraction(alt[i], 1.2));
+      const astro::Vec3 enu = astro::vector::horizontalToENU(horizontal);
+      assert(east[i] == enu.x && north[i] == enu.y && up[i] == enu.z);
+      float x = 0.0f;
+      float y = 0.0f;
+      const bool expected = astro::vector::projectToScreen(enu, projection, x, y);
+      assert(visible[i] == (expected ? 1 : 0));
+      assert(!expected || (screenX[i] == x && screenY[i] == y));
+      expectedOnScreen += expected ? 1 : 0;
+    }
+    assert(onScreen == expectedOnScreen && onScreen > 0);
+  }
+
+  // Apparent place of theta Persei on 2028 Nov 13.19 (Meeus, examples 21.b
+  // and 23.a), from its J2000 place carried forward by proper motion.
+  {
+    const astro::transform::ApparentFrame frame = astro::transform::apparentFrame(2462088.69);
+    const astro::Vec3 apparent = astro::normalize(
+        frame.biasPrecessionNutation * astro::vector::equatorialToUnit(41.054063, 49.227750) + frame.aberration);
+    const astro::Vec3 expected = astro::vector::equatorialToUnit(41.5599646, 49.3520685);
+    assert(astro::magnitude(apparent - expected) < 0.5 / 3600.0 * kDegToRad);
+    // Meeus has 14.861 arcsec of nutation in longitude; times cos(eps).
+    assert(std::fabs(frame.equationOfEquinoxesRad - 13.63 / 3600.0 * kDegToRad) < 0.3 / 3600.0 * kDegToRad);
+  }
+
   return 0;
 }
@@ -0,0 +1,155 @@
+#include "astro/time.hpp"
+#include "astro/transform.hpp"
+#include "astro/vector.hpp"
+#include "astro/visibility.hpp"
+
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace {
+constexpr double kTwoPi = 6.28318530717958647692;
+
+double angleBetween(double a, double b) {
+  const double d = std::fabs(a - b);
+  return std::fmin(d, kTwoPi - d);
+}
+}  // namespace
+
+int main() {
+  // 10 x 22.5 deg grid plus the pole, 273 stars, so the last bitset word is
+  // partly used.
+  std::vector<astro::StarIn> stars;
+  int hip = 1;
+  for (double dec = -80.0; dec <= 80.0; dec += 10.0) {
+    for (double ra = 7.0; ra < 360.0; ra += 22.5) {
+      stars.push_back({ra, dec, 1.0 + (hip % 50) * 0.1, hip});
+      hip += 1;
+    }
+  }
+  stars.push_back({0.0, 90.0, 2.0, hip});
+  astro::StarCatalog catalog;
+  catalog.assign(stars);
+  assert(catalog.slotOf(0) != 0 || catalog.slotOf(1) != 1);
+
+  // Two sites share a longitude; one has its own pressure and temperature.
+  const std::vector<astro::Observer> observers = {
+      {37.7749, -122.4194, 0.0},
+      {-33.8688, 151.2093, 50.0},
+      {49.2827, -122.4194, 0.0},
+      {64.1466, -21.9426, 2000.0, 0.0, -15.0},
+  };
+  const std::vector<double> jds = {2460000.5, 2460000.5 + 1.0 / 24.0, 2460000.5 + 7.0 / 24.0};
+  const std::size_t floats = astro::visibility::altAzFloats(jds.size(), observers.size(), stars.size());
+
+  astro::visibility::GridOptions options;
+  options.threads = 3;
+
+  for (const bool refraction : {false, true}) {
+    options.applyRefraction = refraction;
+    std::vector<float> altAz(floats);
+    const bool computed = astro::visibility::computeAltAz(catalog, observers, jds, altAz, options);
+    assert(computed);
+    const astro::visibility::Bitsets bits = astro::visibility::computeBitsets(catalog, observers, jds, options);
+    assert(bits.times == jds.size() && bits.observers == observers.size() && bits.stars == stars.size());
+    assert(bits.rowWords == 5);
+
+    for (std::size_t t = 0; t < jds.size(); ++t) {
+      for (std::size_t o = 0; o < observers.size(); ++o) {
+        const astro::Observer& observer = observers[o];
+        const double lst = astro::time::localSiderealTimeRad(jds[t], observer.lonDeg);
+        const double factor = astro::transform::refractionFactor(observer);
+        for (std::size_t s = 0; s < stars.size(); ++s) {
+          const astro::Horizontal expected =
+              astro::transform::equatorialToHorizontal(stars[s].raDeg, stars[s].decDeg, lst, observer.latDeg);
+          const double alt = refraction ? astro::transform::applyRefraction(expected.altRad, factor) : expected.altRad;
+          const float* actual = altAz.data() + ((t * observers.size() + o) * stars.size() + s) * 2;
+          assert(std::fabs(actual[0] - alt) < 5e-5);
+          assert(actual[1] >= 0.0f && actual[1] <= static_cast<float>(kTwoPi));
+          if (std::cos(expected.altRad) > 0.05) {
+            assert(angleBetween(actual[1], expected.azRad) < 1e-4);
+          }
+          if (std::fabs(alt) > 1e-4) {
+            assert(bits.visible(t, o, s) == (alt >= 0.0));
+          }
+        }
+        // Bits past the last star stay clear.
+        assert(bits.row(t, o).back() >> (stars.size() % 64) == 0);
+      }
+    }
+
+    // The split across threads does not change the results.
+    astro::visibility::GridOptions serial = options;
+    serial.threads = 1;
+    std::vector<float> serialAltAz(floats);
+    const bool serialComputed = astro::visibility::computeAltAz(catalog, observers, jds, serialAltAz, serial);
+    assert(serialComputed);
+    assert(std::memcmp(serialAltAz.data(), altAz.data(), floats * sizeof(float)) == 0);
+    assert(astro::visibility::computeBitsets(catalog, observers, jds, serial).words == bits.words);
+  }
+
+  // A raised cutoff keeps a subset of the stars.
+  options.minAltDeg = 30.0;
+  const astro::visibility::Bitsets high = astro::visibility::computeBitsets(catalog, observers, jds, options);
+  options.minAltDeg = 0.0;
+  const astro::visibility::Bitsets all = astro::visibility::computeBitsets(catalog, observers, jds, options);
+  std::size_t highCount = 0;
+  std::size_t allCount = 0;
+  for (std::size_t w = 0; w < all.words.size(); ++w) {
+    assert((high.words[w] & ~all.words[w]) == 0);
+    highCount += static_cast<std::size_t>(std::popcount(high.words[w]));
+    allCount += static_cast<std::size_t>(std::popcount(all.words[w]));
+  }
+  assert(highCount > 0 && highCount < allCount);
+
+  // Tracks stay on the exact path across 500 two-minute steps, with the
+  // default anchoring and with none at all.
+  const std::size_t samples = 500;
+  const double dt = 2.0 / 1440.0;
+  const std::size_t trackSize = astro::visibility::trackFloats(samples, stars.size());
+  std::vector<float> track(trackSize);
+  std::vector<float> unanchored(trackSize);
+  astro::visibility::TrackOptions trackOptions;
+  trackOptions.threads = 2;
+  const bool tracked =
+      astro::visibility::computeTracks(catalog, observers[0], jds[0], dt, samples, track, trackOptions);
+  assert(tracked);
+  trackOptions.anchorInterval = samples;
+  const bool unanchoredTracked =
+      astro::visibility::computeTracks(catalog, observers[0], jds[0], dt, samples, unanchored, trackOptions);
+  assert(unanchoredTracked);
+  double maxError = 0.0;
+  double maxUnanchoredError = 0.0;
+  for (std::size_t k = 0; k < samples; ++k) {
+    const double jd = jds[0] + static_cast<double>(k) * dt;
+    const astro::Mat3 toENU = astro::transform::equatorialToENUMatrix(
+        astro::time::localSiderealTimeRad(jd, observers[0].lonDeg), observers[0].latDeg);
+    for (std::size_t s = 0; s < stars.size(); ++s) {
+      const astro::Vec3 expected = toENU * astro::vector::equatorialToUnit(stars[s].raDeg, stars[s].decDeg);
+      const float* actual = track.data() + (k * stars.size() + s) * 3;
+      const float* drifted = unanchored.data() + (k * stars.size() + s) * 3;
+      maxError = std::fmax(maxError, astro::magnitude(expected - astro::Vec3{actual[0], actual[1], actual[2]}));
+      maxUnanchoredError =
+          std::fmax(maxUnanchoredError, astro::magnitude(expected - astro::Vec3{drifted[0], drifted[1], drifted[2]}));
+    }
+  }
+  assert(maxError < 1e-5);
+  assert(maxUnanchoredError < 5e-5);
+  trackOptions.threads = 1;
+  trackOptions.anchorInterval = 64;
+  std::vector<float> serialTrack(trackSize);
+  const bool serialTracked =
+      astro::visibility::computeTracks(catalog, observers[0], jds[0], dt, samples, serialTrack, trackOptions);
+  assert(serialTracked);
+  assert(std::memcmp(serialTrack.data(), track.data(), trackSize * sizeof(float)) == 0);
+  serialTrack.pop_back();
+  assert(!astro::visibility::computeTracks(catalog, observers[0], jds[0], dt, samples, serialTrack, trackOptions));
+
+  // A short output span is rejected; empty grids are fine.
+  std::vector<float> small(floats - 1);
+  assert(!astro::visibility::computeAltAz(catalog, observers, jds, small, options));
+  assert(astro::visibility::computeBitsets(catalog, {}, jds, options).words.empty());
+  return 0;
+}
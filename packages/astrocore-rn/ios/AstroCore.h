@@ -12,6 +12,12 @@ NS_ASSUME_NONNULL_BEGIN
 
 + (void)installOnBridge:(RCTBridge *)bridge;
 
+/**
+ Releases the JSI values the bindings cache in the bridge's runtime. Call on
+ the JS thread before the bridge is invalidated.
+ */
++ (void)uninstallFromBridge:(RCTBridge *)bridge;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -30,4 +30,14 @@
   astro::jsi::install(*runtime);
 }
 
++ (void)uninstallFromBridge:(RCTBridge *)bridge {
+  if (![bridge isKindOfClass:[RCTCxxBridge class]]) {
+    return;
+  }
+  facebook::jsi::Runtime *runtime = ((RCTCxxBridge *)bridge).runtime;
+  if (runtime != nil) {
+    astro::jsi::uninstall(*runtime);
+  }
+}
+
 @end
@@ -1,21 +1,63 @@
-import type { EngineConfig, FrameMeta, ObserverConfig, PoseQuat, StarIn } from './types';
+import type {
+  CatalogOptions,
+  EngineConfig,
+  FrameFormat,
+  FrameMeta,
+  FrameStats,
+  FrameView,
+  ObserverConfig,
+  PoseQuat,
+  StarIn
+} from './types';
 
 type NativeAstroCore = {
   install: () => void;
   startEngine: (config: EngineConfig) => boolean;
   stopEngine: () => void;
-  setStars: (stars: Float32Array | StarIn[]) => boolean;
+  setStars: (stars: Float32Array | StarIn[], options?: CatalogOptions) => boolean;
+  setStarsRange: (offset: number, stars: Float32Array | StarIn[]) => void;
+  setStarColors: (offset: number, bv: Float32Array) => void;
+  loadCatalog: (path: string) => boolean;
+  setLimitingMag: (limitingMag: number) => void;
   setObserver: (observer: ObserverConfig) => void;
   setConfig: (config: EngineConfig) => void;
   updatePose: (pose: PoseQuat) => void;
-  computeFrame: (tUnixMs: FrameMeta['tUnixMs']) => number;
+  pushPose: (tUnixMs: number, w: number, x: number, y: number, z: number) => void;
+  computeFrame: (tUnixMs: FrameMeta['tUnixMs'], displayTimeMs?: number) => number;
+  computeFrameWithPose: (tUnixMs: number, w: number, x: number, y: number, z: number) => number;
+  computeFrameWithPoseBatch: (samples: Float64Array, count: number) => number;
+  getFrameStats: () => FrameStats;
+  resetFrameStats: () => void;
+  startTrace: () => void;
+  stopTrace: () => void;
+  dumpTrace: (path: string) => boolean;
+  getFrameSlots: () => ArrayBuffer[];
+  acquireFrame: () => number;
+  /** @deprecated Allocates a view per call; SkyEngine.getFrameBuffer() no longer uses it. */
   getFrameBuffer: () => Float32Array;
 };
 
+// Layout of the header at the start of every frame slot (see RingBuffer.hpp).
+const FRAME_HEADER_BYTES = 64;
+const FRAME_HEADER_DOUBLES = FRAME_HEADER_BYTES / 8;
+const HEADER_SEQUENCE = 0;
+const HEADER_JULIAN_DATE = 1;
+const HEADER_COUNT = 2;
+const HEADER_FORMAT = 4;
+const HEADER_CAPACITY = 5;
+const HEADER_COLUMN_1 = 6;
+const HEADER_COLUMN_2 = 7;
+// Indexed by the header's format field (FrameFormat in types.hpp).
+const FRAME_FORMATS: FrameFormat[] = ['float32', 'fixed16', 'half', 'vertex'];
+
 const ASTRO_GLOBAL_KEY = 'AstroCore';
 
 let cachedHost: NativeAstroCore | null = null;
 let installed = false;
+let frameViews: FrameView[] | null = null;
+let frameSlots: ArrayBuffer[] = [];
+// Whether each view's arrays have been bound from a committed header yet.
+let frameViewsBound: boolean[] = [];
 
 function resolveHost(): NativeAstroCore {
   if (cachedHost) {
@@ -51,24 +93,81 @@ export function install(): void {
   }
 
   host.install();
+  frameViews = null;
+  frameSlots = [];
+  frameViewsBound = [];
   cachedHost = (globalThis as Record<string, unknown>)[ASTRO_GLOBAL_KEY] as NativeAstroCore | null;
   installed = true;
 }
 
 export function startEngine(config: EngineConfig): boolean {
-  return ensureInstalled().startEngine(config);
+  const host = ensureInstalled();
+  const started = host.startEngine(config);
+  resolveFrameViews(host);
+  return started;
 }
 
-export function stopEngine(): void {
-  ensureInstalled().stopEngine();
+// The arrays start empty: the capacity and column offsets they are sized from
+// are only in the header once a frame has been committed to the slot.
+function resolveFrameViews(host: NativeAstroCore): FrameView[] {
+  if (!frameViews) {
+    frameSlots = host.getFrameSlots();
+    frameViewsBound = frameSlots.map(() => false);
+    frameViews = frameSlots.map((buffer, slot) => ({
+      slot,
+      sequence: 0,
+      julianDate: 0,
+      count: 0,
+      format: 'float32',
+      header: new Float64Array(buffer, 0, FRAME_HEADER_DOUBLES),
+      stars: new Float32Array(0),
+      positions: new Int16Array(0),
+      magnitudes: new Uint8Array(0),
+      vertices: new Float32Array(0),
+      ids: new Uint32Array(0)
+    }));
+  }
+  return frameViews;
 }
 
-export function setStars(stars: Float32Array | StarIn[]): boolean {
-  const host = ensureInstalled();
-  if (stars instanceof Float32Array) {
-    return host.setStars(stars);
+// Sizes a slot's arrays from its header; runs on first use and when the format changes.
+function bindFrameColumns(view: FrameView, buffer: ArrayBuffer, format: FrameFormat): void {
+  const capacity = view.header[HEADER_CAPACITY];
+  const magnitudesOffset = view.header[HEADER_COLUMN_1];
+  const idsOffset = view.header[HEADER_COLUMN_2];
+  view.format = format;
+  if (format === 'float32') {
+    view.stars = new Float32Array(buffer, FRAME_HEADER_BYTES, capacity * 4);
+    view.positions = new Int16Array(0);
+    view.magnitudes = new Uint8Array(0);
+    view.vertices = new Float32Array(0);
+    view.ids = new Uint32Array(0);
+    return;
   }
+  view.stars = new Float32Array(0);
+  if (format === 'vertex') {
+    view.positions = new Int16Array(0);
+    view.magnitudes = new Uint8Array(0);
+    view.vertices = new Float32Array(buffer, FRAME_HEADER_BYTES, capacity * 4);
+    view.ids = new Uint32Array(buffer, magnitudesOffset, capacity);
+    return;
+  }
+  view.vertices = new Float32Array(0);
+  view.ids = new Uint32Array(buffer, idsOffset, capacity);
+  if (format === 'fixed16') {
+    view.positions = new Int16Array(buffer, FRAME_HEADER_BYTES, capacity * 2);
+    view.magnitudes = new Uint8Array(buffer, magnitudesOffset, capacity);
+  } else {
+    view.positions = new Uint16Array(buffer, FRAME_HEADER_BYTES, capacity * 2);
+    view.magnitudes = new Uint16Array(buffer, magnitudesOffset, capacity);
+  }
+}
+
+export function stopEngine(): void {
+  ensureInstalled().stopEngine();
+}
 
+function packStars(stars: StarIn[]): Float32Array {
   const packed = new Float32Array(stars.length * 4);
   for (let i = 0; i < stars.length; i += 1) {
     const star = stars[i];
@@ -78,8 +177,73 @@ export function setStars(stars: Float32Array | StarIn[]): boolean {
     packed[base + 2] = star.mag;
     packed[base + 3] = star.hip ?? 0;
   }
+  return packed;
+}
+
+// B–V of each star, or null when none has one; packed records carry no color.
+function packColors(stars: StarIn[]): Float32Array | null {
+  if (!stars.some((star) => star.bv !== undefined)) {
+    return null;
+  }
+  const colors = new Float32Array(stars.length);
+  for (let i = 0; i < stars.length; i += 1) {
+    colors[i] = stars[i].bv ?? NaN;
+  }
+  return colors;
+}
+
+export function setStars(stars: Float32Array | StarIn[], options?: CatalogOptions): boolean {
+  const host = ensureInstalled();
+  if (stars instanceof Float32Array) {
+    return host.setStars(stars, options);
+  }
+  const loaded = host.setStars(packStars(stars), options);
+  const colors = packColors(stars);
+  if (loaded && colors) {
+    host.setStarColors(0, colors);
+  }
+  return loaded;
+}
+
+export function setStarsRange(offset: number, stars: Float32Array | StarIn[]): void {
+  const host = ensureInstalled();
+  if (stars instanceof Float32Array) {
+    host.setStarsRange(offset, stars);
+    return;
+  }
+  host.setStarsRange(offset, packStars(stars));
+  // Only runs of stars that carry a B–V are written, so a patch that leaves
+  // it out keeps the colors already set.
+  let begin = 0;
+  while (begin < stars.length) {
+    if (stars[begin].bv === undefined) {
+      begin += 1;
+      continue;
+    }
+    let end = begin;
+    while (end < stars.length && stars[end].bv !== undefined) {
+      end += 1;
+    }
+    const colors = new Float32Array(end - begin);
+    for (let i = begin; i < end; i += 1) {
+      colors[i - begin] = stars[i].bv as number;
+    }
+    host.setStarColors(offset + begin, colors);
+    begin = end;
+  }
+}
+
+/** B–V color index of the stars from `offset` on, in input order; NaN for unknown. */
+export function setStarColors(offset: number, bv: Float32Array): void {
+  ensureInstalled().setStarColors(offset, bv);
+}
+
+export function loadCatalog(path: string): boolean {
+  return ensureInstalled().loadCatalog(path);
+}
 
-  return host.setStars(packed);
+export function setLimitingMag(limitingMag: number): void {
+  ensureInstalled().setLimitingMag(limitingMag);
 }
 
 export function setObserver(observer: ObserverConfig): void {
@@ -90,14 +254,105 @@ export function setConfig(config: EngineConfig): void {
   ensureInstalled().setConfig(config);
 }
 
+/** Sets the pose and clears the pushPose() history. */
 export function updatePose(pose: PoseQuat): void {
   ensureInstalled().updatePose(pose);
 }
 
-export function computeFrame(tUnixMs: FrameMeta['tUnixMs']): number {
-  return ensureInstalled().computeFrame(tUnixMs);
+/**
+ * Records a sensor sample taken at `tUnixMs` and makes it the current pose. Frames
+ * asked for a display time, and native-loop frames, draw the pose predicted from
+ * these samples.
+ */
+export function pushPose(tUnixMs: number, w: number, x: number, y: number, z: number): void {
+  ensureInstalled().pushPose(tUnixMs, w, x, y, z);
+}
+
+/**
+ * Renders the sky at `tUnixMs`. With `displayTimeMs`, the pose is slerped or
+ * extrapolated from the pushPose() history to when the frame will be shown.
+ */
+export function computeFrame(tUnixMs: FrameMeta['tUnixMs'], displayTimeMs?: number): number {
+  const host = ensureInstalled();
+  return displayTimeMs === undefined ? host.computeFrame(tUnixMs) : host.computeFrame(tUnixMs, displayTimeMs);
+}
+
+/** updatePose() + computeFrame() in a single native call, with the pose passed as numbers. */
+export function computeFrameWithPose(tUnixMs: number, w: number, x: number, y: number, z: number): number {
+  return ensureInstalled().computeFrameWithPose(tUnixMs, w, x, y, z);
+}
+
+/**
+ * Frame from a reusable Float64Array of `count` (tUnixMs, w, x, y, z) samples,
+ * oldest first. Every sample goes into the pose history, as with pushPose(),
+ * so native frames keep predicting from them; the last one sets the pose and
+ * the frame time.
+ */
+export function computeFrameWithPoseBatch(samples: Float64Array, count: number): number {
+  return ensureInstalled().computeFrameWithPoseBatch(samples, count);
+}
+
+/**
+ * Latest frame, or null before the first one. Allocation-free: the returned
+ * view is cached per slot (its arrays are rebuilt only when the frame format
+ * changes) and stays intact until the next getFrame() or getFrameBuffer() call.
+ */
+export function getFrame(): FrameView | null {
+  const host = ensureInstalled();
+  const slot = host.acquireFrame();
+  if (slot < 0) {
+    return null;
+  }
+  const view = resolveFrameViews(host)[slot];
+  const format = FRAME_FORMATS[view.header[HEADER_FORMAT]];
+  if (format !== view.format || !frameViewsBound[slot]) {
+    bindFrameColumns(view, frameSlots[slot], format);
+    frameViewsBound[slot] = true;
+  }
+  view.sequence = view.header[HEADER_SEQUENCE];
+  view.julianDate = view.header[HEADER_JULIAN_DATE];
+  view.count = view.header[HEADER_COUNT];
+  return view;
+}
+
+export function getFrameStats(): FrameStats {
+  return ensureInstalled().getFrameStats();
+}
+
+export function resetFrameStats(): void {
+  ensureInstalled().resetFrameStats();
+}
+
+/** Starts recording engine, worker and JSI spans into the native trace ring, dropping earlier ones. */
+export function startTrace(): void {
+  ensureInstalled().startTrace();
+}
+
+export function stopTrace(): void {
+  ensureInstalled().stopTrace();
+}
+
+/** Writes the recorded spans as Chrome trace-event JSON for Perfetto; false if the file cannot be written. */
+export function dumpTrace(path: string): boolean {
+  return ensureInstalled().dumpTrace(path);
 }
 
+const EMPTY_FRAME = new Float32Array(0);
+
+/**
+ * Latest frame trimmed to its visible stars, for the `float32` format only.
+ * Reads the same cached slot views as getFrame(), so no native buffer is
+ * created; only the trimmed subarray is new.
+ *
+ * @deprecated Use getFrame() and read the first `count * 4` entries of `stars`.
+ */
 export function getFrameBuffer(): Float32Array {
-  return ensureInstalled().getFrameBuffer();
+  const frame = getFrame();
+  if (!frame) {
+    return EMPTY_FRAME;
+  }
+  if (frame.format !== 'float32') {
+    throw new Error('AstroCore.getFrameBuffer only serves the float32 frame format; use getFrame().');
+  }
+  return frame.stars.subarray(0, frame.count * 4);
 }
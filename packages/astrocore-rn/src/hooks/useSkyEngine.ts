@@ -1,34 +1,44 @@
 import { useEffect, useMemo, useRef, useState } from 'react';
-import type { PoseQuat } from '../types';
-import { computeFrame, getFrameBuffer, updatePose } from '../SkyEngine';
+import type { FrameView, PoseQuat } from '../types';
+import { computeFrame, computeFrameWithPose, getFrame, pushPose } from '../SkyEngine';
 
 type UseSkyEngineOptions = {
   poseProvider: () => PoseQuat | null;
   frameIntervalMs?: number;
   active?: boolean;
   timestampProvider?: () => number;
+  /** Frames are rendered by the native loop (frameRateHz/frameOnPose); only pose and buffer are polled. */
+  nativeFrameLoop?: boolean;
 };
 
 type UseSkyEngineResult = {
+  /** Latest frame in whatever `frameFormat` the engine renders; read its columns for the first `frameCount` stars. */
+  frame: FrameView | null;
+  /**
+   * `float32` records of the latest frame, sized for the slot's capacity; read the first `frameCount * 4`
+   * entries. Null for the other formats, whose data is only in `frame`.
+   */
   frameBuffer: Float32Array | null;
   frameCount: number;
 };
 
 /**
  * Convenience hook that polls device pose and drives the AstroCore frame loop.
- * The hook avoids any allocations in the hot path by reusing the Float32Array
- * returned from `getFrameBuffer()`.
+ * The hook avoids any allocations in the hot path by reading frames through
+ * the per-slot views cached by `getFrame()`.
  */
 export function useSkyEngine(options: UseSkyEngineOptions): UseSkyEngineResult {
   const {
     poseProvider,
     frameIntervalMs = 16,
     active = true,
-    timestampProvider = Date.now
+    timestampProvider = Date.now,
+    nativeFrameLoop = false
   } = options;
 
   const [frameCount, setFrameCount] = useState(0);
-  const frameRef = useRef<Float32Array | null>(null);
+  const [frameSequence, setFrameSequence] = useState(0);
+  const frameRef = useRef<FrameView | null>(null);
 
   useEffect(() => {
     if (!active) {
@@ -44,13 +54,19 @@ export function useSkyEngine(options: UseSkyEngineOptions): UseSkyEngineResult {
       }
 
       const pose = poseProvider();
-      if (pose) {
-        updatePose(pose);
+      if (nativeFrameLoop) {
+        if (pose) {
+          pushPose(timestampProvider(), pose.w, pose.x, pose.y, pose.z);
+        }
+      } else if (pose) {
+        computeFrameWithPose(timestampProvider(), pose.w, pose.x, pose.y, pose.z);
+      } else {
+        computeFrame(timestampProvider());
       }
-
-      const count = computeFrame(timestampProvider());
-      frameRef.current = getFrameBuffer();
-      setFrameCount(count);
+      const frame = getFrame();
+      frameRef.current = frame;
+      setFrameCount(frame ? frame.count : 0);
+      setFrameSequence(frame ? frame.sequence : 0);
 
       if (frameIntervalMs <= 16) {
         rafHandle = requestAnimationFrame(tick);
@@ -76,13 +92,14 @@ export function useSkyEngine(options: UseSkyEngineOptions): UseSkyEngineResult {
         cancelAnimationFrame(rafHandle);
       }
     };
-  }, [active, frameIntervalMs, poseProvider, timestampProvider]);
+  }, [active, frameIntervalMs, nativeFrameLoop, poseProvider, timestampProvider]);
 
   return useMemo(
     () => ({
-      frameBuffer: frameRef.current,
+      frame: frameRef.current,
+      frameBuffer: frameRef.current && frameRef.current.format === 'float32' ? frameRef.current.stars : null,
       frameCount
     }),
-    [frameCount]
+    [frameCount, frameSequence]
   );
 }
@@ -1,2 +1,2 @@
-export { install, startEngine, stopEngine, setStars, setObserver, setConfig, updatePose, computeFrame, getFrameBuffer } from './SkyEngine';
-export type { StarIn, EngineConfig, FrameMeta, ObserverConfig, PoseQuat } from './types';
+export { install, startEngine, stopEngine, setStars, setStarsRange, setStarColors, loadCatalog, setLimitingMag, setObserver, setConfig, updatePose, pushPose, computeFrame, computeFrameWithPose, computeFrameWithPoseBatch, getFrame, getFrameBuffer, getFrameStats, resetFrameStats, startTrace, stopTrace, dumpTrace } from './SkyEngine';
+export type { StarIn, CatalogOptions, EngineConfig, FrameFormat, FrameMeta, FrameStats, FrameView, Percentiles, ObserverConfig, PointStyle, PoseQuat } from './types';
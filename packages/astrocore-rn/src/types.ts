@@ -3,6 +3,34 @@ export type StarIn = {
   decDeg: number;
   mag: number;
   hip?: number;
+  /** B–V color index; stars without one draw white in `vertex` frames. */
+  bv?: number;
+};
+
+/**
+ * Storage of each frame's visible stars:
+ * - `float32`: (x, y, mag, hip) float records in `stars`; 16 bytes per star.
+ * - `fixed16`: int16 (x, y) in 1/8 px, uint8 magnitude in 1/16 mag steps from -2, and exact uint32 ids;
+ *   9 bytes per star.
+ * - `half`: half-float (x, y) and magnitude bit patterns, and exact uint32 ids; 10 bytes per star.
+ * - `vertex`: interleaved (x, y, size, color) vertices ready for a point draw call, and exact uint32 ids;
+ *   20 bytes per star. The color is packed as bytes R, G, B, A.
+ */
+export type FrameFormat = 'float32' | 'fixed16' | 'half' | 'vertex';
+
+/**
+ * Point size (px) and opacity of `vertex` frames as linear functions of magnitude:
+ * `sizeAtMag0 - sizePerMag * mag` clamped to [minSize, maxSize], and
+ * `alphaAtMag0 - alphaPerMag * mag` clamped to [minAlpha, 1].
+ */
+export type PointStyle = {
+  sizeAtMag0?: number;
+  sizePerMag?: number;
+  minSize?: number;
+  maxSize?: number;
+  alphaAtMag0?: number;
+  alphaPerMag?: number;
+  minAlpha?: number;
 };
 
 export type EngineConfig = {
@@ -10,6 +38,40 @@ export type EngineConfig = {
   width: number;
   height: number;
   applyRefraction?: boolean;
+  /** Threads sharing each frame, including the JS thread. Defaults to 1. */
+  workerThreads?: number;
+  /** Faintest magnitude drawn. Defaults to no limit. */
+  limitingMag?: number;
+  /** Treat limitingMag as the limit at the default 60° FOV and deepen it when zoomed in. */
+  limitingMagFollowsFov?: boolean;
+  /** Sky rotation (degrees) tolerated before the sidereal transform is rebuilt. Defaults to 0.001. */
+  siderealToleranceDeg?: number;
+  /**
+   * Treat star RA/Dec as J2000 and draw apparent places of date (precession, nutation, annual aberration).
+   * Defaults to false, which draws RA/Dec as coordinates of date.
+   */
+  apparentPlaces?: boolean;
+  /** Days the date may move before the apparent-place frame is rebuilt. Defaults to 1. */
+  apparentFrameIntervalDays?: number;
+  /** Record per-frame stage timings and cull counters for getFrameStats(). Defaults to false. */
+  recordFrameStats?: boolean;
+  /** Render frames natively at this rate (Hz) instead of on computeFrame calls. Only read by startEngine. */
+  frameRateHz?: number;
+  /** Render a native frame after every updatePose. Only read by startEngine. */
+  frameOnPose?: boolean;
+  /** Layout of the frame buffer. Defaults to `float32`. */
+  frameFormat?: FrameFormat;
+  /** Size and opacity curve of `vertex` frames; omitted fields keep their defaults. */
+  pointStyle?: PointStyle;
+  /** Furthest (ms) the pose is extrapolated past the newest pushPose() sample. Defaults to 50. */
+  maxPoseLeadMs?: number;
+  /** Tick-to-screen latency (ms) the native frame loop predicts the pose for. Defaults to 0. */
+  displayLatencyMs?: number;
+};
+
+export type CatalogOptions = {
+  /** Sort stars brightest-first within each sky tile. Defaults to true. */
+  sortByMagnitude?: boolean;
 };
 
 export type FrameMeta = {
@@ -18,10 +80,67 @@ export type FrameMeta = {
   lon: number;
 };
 
+/**
+ * A frame-buffer slot as seen from JS. One view exists per native slot and is
+ * reused for every frame that lands in it; `getFrame()` refreshes the scalar
+ * fields from the slot header and returns it.
+ */
+export type FrameView = {
+  slot: number;
+  sequence: number;
+  julianDate: number;
+  /** Visible stars; only the first `count` records of each array are current. */
+  count: number;
+  /** Format of the current frame; decides which arrays below are filled. */
+  format: FrameFormat;
+  /** Slot header: sequence, JD, count, slot, format, capacity, column offsets. */
+  header: Float64Array;
+  /** `float32`: (x, y, mag, hip) records, sized for the slot's full capacity. Empty otherwise. */
+  stars: Float32Array;
+  /** `fixed16`: int16 (x, y) pairs; `half`: half-float (x, y) bit patterns. Empty for `float32`. */
+  positions: Int16Array | Uint16Array;
+  /** `fixed16`: uint8 magnitudes; `half`: half-float bit patterns. Empty for `float32`. */
+  magnitudes: Uint8Array | Uint16Array;
+  /**
+   * `vertex`: (x, y, size, color) vertices; the color float holds the packed RGBA bytes, so
+   * hand `vertices.buffer` with this view's byte offset to the draw call. Empty otherwise.
+   */
+  vertices: Float32Array;
+  /** Exact catalog ids for the compact and vertex formats. Empty for `float32`. */
+  ids: Uint32Array;
+};
+
+export type FrameStage = 'sidereal' | 'transform' | 'cull' | 'project' | 'commit' | 'total';
+
+export type FrameCounter = 'tileCulled' | 'faint' | 'belowHorizon' | 'behindCamera' | 'offScreen' | 'emitted';
+
+export type Percentiles = {
+  p50: number;
+  p95: number;
+  p99: number;
+};
+
+/** Rolling statistics over the latest frames recorded with `recordFrameStats`. */
+export type FrameStats = {
+  /** Frames recorded since the last reset. */
+  frames: number;
+  /** How many of the latest frames the percentiles cover. */
+  window: number;
+  stageMicros: Record<FrameStage, Percentiles>;
+  /** Where the catalog's stars went in each frame. */
+  counters: Record<FrameCounter, Percentiles>;
+  lastStageMicros: Record<FrameStage, number>;
+  lastCounters: Record<FrameCounter, number>;
+};
+
 export type ObserverConfig = {
   latDeg: number;
   lonDeg: number;
   elevationM?: number;
+  /** Air pressure for refraction. Defaults to the standard atmosphere at elevationM. */
+  pressureHPa?: number;
+  /** Air temperature for refraction. Defaults to 10 °C. */
+  temperatureC?: number;
 };
 
 export type PoseQuat = {